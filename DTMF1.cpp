@@ -2,82 +2,87 @@
 #include <SFML/Window.hpp>
 #include <cmath>
 #include <iostream>
-#include <map>
+#include "synth.hpp"
 
 const int SAMPLE_RATE = 44100;
-const double PI = 3.14159265358979323846;
 const int AMPLITUDE = 30000;
 
-// Map DTMF frequencies
-std::map<sf::Keyboard::Key, std::pair<int, int> > dtmfFrequencies = {
-    {sf::Keyboard::Num1, {697, 1209}}, // 1
-    {sf::Keyboard::Num2, {697, 1336}}, // 2
-    {sf::Keyboard::Num3, {697, 1477}}, // 3
-    {sf::Keyboard::Num4, {770, 1209}}, // 4
-    {sf::Keyboard::Num5, {770, 1336}}, // 5
-    {sf::Keyboard::Num6, {770, 1477}}, // 6
-    {sf::Keyboard::Num7, {852, 1209}}, // 7
-    {sf::Keyboard::Num8, {852, 1336}}, // 8
-    {sf::Keyboard::Num9, {852, 1477}}, // 9
-    {sf::Keyboard::O, {941, 1209}},     // * (mapped to o)
-    {sf::Keyboard::Num0, {941, 1336}},  // 0
-    {sf::Keyboard::P, {941, 1477}}      // # (mapped to P)
+// Keyboard key for each DTMF symbol
+struct KeyTone {
+    sf::Keyboard::Key key;
+    char symbol;
 };
 
-// Generate DTMF tone by combining two frequencies
-void generateDTMFTone(sf::Keyboard::Key key, std::vector<sf::Int16>& samples, int durationInSeconds) {
-    if (dtmfFrequencies.find(key) == dtmfFrequencies.end()) return;
+constexpr KeyTone keyTones[] = {
+    {sf::Keyboard::Num1, '1'}, {sf::Keyboard::Num2, '2'}, {sf::Keyboard::Num3, '3'},
+    {sf::Keyboard::Num4, '4'}, {sf::Keyboard::Num5, '5'}, {sf::Keyboard::Num6, '6'},
+    {sf::Keyboard::Num7, '7'}, {sf::Keyboard::Num8, '8'}, {sf::Keyboard::Num9, '9'},
+    {sf::Keyboard::O, '*'},    // * (mapped to o)
+    {sf::Keyboard::Num0, '0'},
+    {sf::Keyboard::P, '#'}     // # (mapped to P)
+};
+constexpr int KEY_COUNT = sizeof(keyTones) / sizeof(keyTones[0]);
 
-    auto frequencies = dtmfFrequencies[key];
-    int sampleCount = SAMPLE_RATE * durationInSeconds;
-    samples.resize(sampleCount);
+// Precompute one looping buffer per key, so a key press only selects a buffer
+void loadToneBuffers(const DTMFSynth& synth, sf::SoundBuffer* buffers) {
+    for (int i = 0; i < KEY_COUNT; ++i) {
+        int row, col;
+        dtmfPosition(keyTones[i].symbol, row, col);
 
-    for (int i = 0; i < sampleCount; ++i) {
-        double sample = 0.5 * (sin(2 * PI * frequencies.first * i / SAMPLE_RATE) +
-                               sin(2 * PI * frequencies.second * i / SAMPLE_RATE));
-        samples[i] = static_cast<sf::Int16>(AMPLITUDE * sample);
+        const std::vector<sf::Int16>& samples = synth.loop(row, col);
+        buffers[i].loadFromSamples(samples.data(), samples.size(), 1, SAMPLE_RATE);
     }
 }
 
 int main() {
-    sf::SoundBuffer buffer;
+    DTMFSynth synth(SAMPLE_RATE, AMPLITUDE);
+    sf::SoundBuffer toneBuffers[KEY_COUNT];
+    loadToneBuffers(synth, toneBuffers);
     sf::Sound sound;
 
-    std::cout << "Press and hold keys 1-9, 0, O (*), or P (#) to play corresponding DTMF tones. Press 'Q' to quit." << std::endl;
-
-    while (true) {
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Q)) break;
-
-        // Check each DTMF key
-        for (const auto& pair : dtmfFrequencies) {
-            sf::Keyboard::Key key = pair.first;
-
-            // Check if the corresponding key is pressed
-            if (sf::Keyboard::isKeyPressed(key)) {
-                std::vector<sf::Int16> samples;
-                generateDTMFTone(key, samples, 1); // Generate a 1-second tone
-
-                // Load samples into buffer and play
-                if (buffer.loadFromSamples(samples.data(), samples.size(), 1, SAMPLE_RATE)) {
-                    sound.setBuffer(buffer);
-                    sound.setLoop(true); // Loop the sound while the key is held down
-                    sound.play();
-
-                    // Wait until the key is released
-                    while (sf::Keyboard::isKeyPressed(key)) {
-                        // Keep playing until the key is released
-                    }
+    // Key events need a focused window; the loop sleeps in waitEvent between them.
+    // Auto-repeat is off, so a held key is one press and one release.
+    sf::Window window(sf::VideoMode(320, 120), "DTMF1");
+    window.setKeyRepeatEnabled(false);
+    std::cout << "Press and hold keys 1-9, 0, O (*), or P (#) in the DTMF1 window to play corresponding DTMF tones. "
+              << "Press 'Q' to quit." << std::endl;
+
+    int playing = -1; // Index of the key whose tone is sounding
+    sf::Event event;
+    while (window.isOpen() && window.waitEvent(event)) {
+        if (event.type == sf::Event::Closed) break;
+        if (event.type == sf::Event::LostFocus && playing >= 0) {
+            // The release would go to another window
+            sound.stop();
+            playing = -1;
+        }
+        if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Q) break;
 
-                    sound.stop(); // Stop the sound when the key is released
-                }
+        int index = -1;
+        if (event.type == sf::Event::KeyPressed || event.type == sf::Event::KeyReleased) {
+            for (int i = 0; i < KEY_COUNT; ++i) {
+                if (keyTones[i].key == event.key.code) index = i;
             }
         }
+        if (index < 0) continue;
+
+        if (event.type == sf::Event::KeyPressed) {
+            // The newest key takes over from one still held
+            sound.setBuffer(toneBuffers[index]);
+            sound.setLoop(true); // Loop the sound while the key is held down
+            sound.play();
+            playing = index;
+        } else if (index == playing) {
+            sound.stop(); // Stop the sound when the key is released
+            playing = -1;
+        }
     }
 
+    window.close();
     std::cout << "Program ended." << std::endl;
     return 0;
 }
 
 
 
-// g++ DTMF1.cpp -o DTMF1 -I/opt/homebrew/opt/sfml/include -L/opt/homebrew/opt/sfml/lib -lsfml-audio -lsfml-system -lsfml-window -std=c++11
\ No newline at end of file
+// g++ DTMF1.cpp -o DTMF1 -I/opt/homebrew/opt/sfml/include -L/opt/homebrew/opt/sfml/lib -lsfml-audio -lsfml-system -lsfml-window -std=c++17
\ No newline at end of file
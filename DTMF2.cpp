@@ -2,124 +2,119 @@
 #include <SFML/Window.hpp>
 #include <cmath>
 #include <iostream>
-#include <map>
 #include <vector>
-#include <sstream>
+#include <cstring>
+#include <memory>
+#include "synth.hpp"
+#include "protocol.hpp"
+#include "audioio.hpp"
+#include "sfmlaudio.hpp"
+#include "transmitqueue.hpp"
 
 const int SAMPLE_RATE = 44100; // Standard sample rate
-const double PI = 3.14159265358979323846; // Pi constant for calculations
 const int AMPLITUDE = 30000; // Amplitude
 const double DURATION = 0.4; // Tone duration in seconds
-
-// Mapping for DTMF tones
-std::map<char, std::pair<int, int>> dtmfFrequencies = {
-    {'#', {941, 1477}}, {'*', {941, 1209}}, // Start and End Signals
-    {'F(1)', {697, 1209}}, {'B(5)', {770, 1336}}, // Forward and Back
-    {'L(9)', {852, 1477}}, {'R(0)', {941, 1336}}, // Left and Right
-    {'0', {941, 1336}}, {'1', {697, 1209}}, {'2', {697, 1336}}, {'3', {697, 1477}}, 
-    {'4', {770, 1209}}, {'5', {770, 1336}}, {'6', {770, 1477}}, {'7', {852, 1209}}, {'8', {852, 1336}}, {'9', {852, 1477}}  
-};
-
-// DTMF tone generation with debugging
-void generateDTMFTone(char c, std::vector<sf::Int16>& samples, double durationInSeconds) {
-    if (dtmfFrequencies.find(c) == dtmfFrequencies.end()) {
-        std::cerr << "Error: Character '" << c << "' not found in DTMF frequencies map.\n";
-        return;
-    }
-
-    auto frequencies = dtmfFrequencies[c];
-    double sampleCount = SAMPLE_RATE * durationInSeconds;
-    samples.resize(sampleCount);
-
-    for (int i = 0; i < sampleCount; ++i) {
-        double sample = 0.5 * (sin(2 * PI * frequencies.first * i / SAMPLE_RATE) +
-                               sin(2 * PI * frequencies.second * i / SAMPLE_RATE));
-        samples[i] = static_cast<sf::Int16>(AMPLITUDE * sample);
-    }
-
-    // Debugging, Log sample size
-    if (samples.empty()) {
-        std::cerr << "Error: Samples array is empty for character '" << c << "'.\n";
-    } else {
-        std::cout << "Generated " << samples.size() << " samples for character '" << c << "'.\n";
-    }
+const double GAP = 0.05; // Silence after each tone in seconds
+const std::size_t TONE_SAMPLES = static_cast<std::size_t>(SAMPLE_RATE * DURATION);
+const std::size_t GAP_SAMPLES = static_cast<std::size_t>(SAMPLE_RATE * GAP);
+const std::size_t LINK_TONE_SAMPLES = SAMPLE_RATE * LINK_TONE_MS / 1000;
+const std::size_t LINK_GAP_SAMPLES = SAMPLE_RATE * LINK_GAP_MS / 1000;
+const std::size_t LINK_PAUSE_SAMPLES = SAMPLE_RATE * (LINK_FRAME_GAP_MS - LINK_GAP_MS) / 1000;
+const std::size_t RESYNC_SAMPLES = SAMPLE_RATE / 10; // Silence before a message that cut another short
+const std::size_t QUEUE_LIMIT = 4;                   // --queue: commands waiting behind the one on the air
+
+// Tone tables, computed once
+const DTMFSynth synth(SAMPLE_RATE, AMPLITUDE);
+
+// Whole message (tones and gaps) in one buffer, sent in one go, so symbol timing
+// comes from the signal rather than from sleeps between symbols
+void renderMessage(const std::string& commands, std::vector<sf::Int16>& samples) {
+    std::string symbols = messageSymbols(buildMessage(commands[0]));
+    synth.renderSequence(symbols, TONE_SAMPLES, GAP_SAMPLES, samples);
 }
 
-// Compute checksum as the ASCII value of the command
-int computeChecksum(char command) {
-    return static_cast<int>(command);
+// Link mode: one short-tone frame for everything pending (a batch frame when commands
+// piled up during the last one), followed by the inter-frame pause so back-to-back
+// frames stay apart at the receiver
+void renderLink(const std::string& commands, std::vector<sf::Int16>& samples) {
+    synth.renderSequence(buildLinkFrame(commands), LINK_TONE_SAMPLES, LINK_GAP_SAMPLES, samples);
+    samples.resize(samples.size() + LINK_PAUSE_SAMPLES, 0);
 }
 
-// Convert checksum to DTMF-compatible string
-std::string encodeChecksum(int checksum) {
-    std::stringstream ss;
-    ss << checksum; // Convert checksum to string
-    return ss.str();
+// Robot command for an arrow key, or '\0'
+char keyCommand(sf::Keyboard::Key key) {
+    return key == sf::Keyboard::Up ? 'F'
+         : key == sf::Keyboard::Down ? 'B'
+         : key == sf::Keyboard::Left ? 'L'
+         : key == sf::Keyboard::Right ? 'R'
+         : '\0';
 }
 
-// Build the command message
-std::string buildMessage(char command) {
-    int checksum = computeChecksum(command);
-    std::string checksumStr = encodeChecksum(checksum); // Convert checksum to string
-    return "#" + std::string(1, command) + checksumStr + "*";
-}
-
-// Transmit message function with validation
-void transmitMessage(const std::string& message, sf::SoundBuffer& buffer, sf::Sound& sound) {
-    for (char c : message) {
-        std::vector<sf::Int16> samples;
-        generateDTMFTone(c, samples, DURATION);
-
-        if (samples.empty()) {
-            std::cerr << "Error: No samples generated for character '" << c << "'. Skipping...\n";
-            continue;
+int main(int argc, char* argv[]) {
+    // DTMF2 [--link] [--queue] [--wav FILE]
+    // --wav sends to a WAV file instead of the speakers, --link sends high-rate link
+    // frames (DTMF5 --link) instead of "#cmd checksum *" messages. Without --link a
+    // new key press cuts the message on the air short; --queue makes it wait instead.
+    bool link = false, queued = false;
+    const char* wavPath = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--link") == 0) link = true;
+        else if (std::strcmp(argv[i], "--queue") == 0) queued = true;
+        else if (std::strcmp(argv[i], "--wav") == 0 && i + 1 < argc) wavPath = argv[++i];
+        else {
+            std::cerr << "Usage: DTMF2 [--link] [--queue] [--wav FILE]\n";
+            return -1;
         }
+    }
 
-        if (buffer.loadFromSamples(samples.data(), samples.size(), 1, SAMPLE_RATE)) {
-            sound.setBuffer(buffer);
-            sound.play();
-            sf::sleep(sf::seconds(DURATION)); // Ensure proper timing
-        } else {
-            std::cerr << "Failed to load sound buffer for character '" << c << "'.\n";
+    SfmlSink speakers(SAMPLE_RATE);
+    std::unique_ptr<WavFileSink> file;
+    if (wavPath) {
+        file.reset(new WavFileSink(wavPath, SAMPLE_RATE));
+        if (!file->isOpen()) {
+            std::cerr << "Cannot write " << wavPath << "\n";
+            return -1;
         }
     }
-}
-
-int main() {
-    sf::SoundBuffer buffer;
-    sf::Sound sound;
-
-    std::cout << "Use arrow keys to control the robot. Press 'Q' to quit." << std::endl;
-
-    while (true) {
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Q)) break;
+    AudioSink& sink = file ? static_cast<AudioSink&>(*file) : speakers;
 
-        char command = '\0';
-
-        // Check for arrow key presses
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Up)) command = 'F';
-        else if (sf::Keyboard::isKeyPressed(sf::Keyboard::Down)) command = 'B';
-        else if (sf::Keyboard::isKeyPressed(sf::Keyboard::Left)) command = 'L';
-        else if (sf::Keyboard::isKeyPressed(sf::Keyboard::Right)) command = 'R';
-
-        if (command != '\0') {
-            std::string message = buildMessage(command);
-            std::cout << "Sending command: " << message << std::endl;
-
-            transmitMessage(message, buffer, sound);
+    // The audio thread plays; this one only waits for key events
+    std::unique_ptr<TransmitQueue> transmitter;
+    if (link) {
+        transmitter.reset(new TransmitQueue(sink, renderLink, LINK_MAX_BATCH, LINK_MAX_BATCH, false, LINK_PAUSE_SAMPLES));
+    } else {
+        transmitter.reset(new TransmitQueue(sink, renderMessage, queued ? QUEUE_LIMIT : 1, 1, !queued, RESYNC_SAMPLES));
+    }
 
-            // Wait until the key is released to prevent repeated transmissions
-            while (sf::Keyboard::isKeyPressed(sf::Keyboard::Up) ||
-                   sf::Keyboard::isKeyPressed(sf::Keyboard::Down) ||
-                   sf::Keyboard::isKeyPressed(sf::Keyboard::Left) ||
-                   sf::Keyboard::isKeyPressed(sf::Keyboard::Right)) {
-            }
+    // Key events need a focused window; holding a key sends once (no auto-repeat)
+    sf::Window window(sf::VideoMode(320, 120), "DTMF2");
+    window.setKeyRepeatEnabled(false);
+    std::cout << "Use arrow keys in the DTMF2 window to control the robot. Press 'Q' to quit." << std::endl;
+
+    sf::Event event;
+    while (window.isOpen() && window.waitEvent(event)) {
+        if (event.type == sf::Event::Closed) break;
+        if (event.type != sf::Event::KeyPressed) continue;
+        if (event.key.code == sf::Keyboard::Q) break;
+
+        char command = keyCommand(event.key.code);
+        if (command == '\0') continue;
+        if (link) {
+            std::cout << "Queued command: " << command << std::endl;
+        } else {
+            std::cout << "Sending command: " << buildMessage(command) << std::endl;
         }
+        if (!transmitter->push(command)) std::cerr << "Transmit queue full, dropped " << command << "\n";
     }
 
+    // Speakers stop at once; a WAV file gets everything that was queued
+    if (!file) transmitter->cancel();
+    transmitter.reset();
+    window.close();
+    file.reset(); // Finishes the WAV header
     std::cout << "Program ended." << std::endl;
     return 0;
 }
 
 // Compile command on mac:
-// g++ DTMF2.cpp -o DTMF2 -I/opt/homebrew/opt/sfml/include -L/opt/homebrew/opt/sfml/lib -lsfml-audio -lsfml-system -lsfml-window -std=c++11
\ No newline at end of file
+// g++ DTMF2.cpp -o DTMF2 -I/opt/homebrew/opt/sfml/include -L/opt/homebrew/opt/sfml/lib -lsfml-audio -lsfml-system -lsfml-window -std=c++17
\ No newline at end of file
@@ -1,153 +1,257 @@
 #include <SFML/Audio.hpp>
 #include <iostream>
-#include <vector>
 #include <cmath>
-#include <map>
 #include <chrono>
-#include <fftw3.h>
-
-const int SAMPLE_RATE = 44100; // Audio sample rate
-const int N = 4096;            // FFT size
-const double PI = 3.14159265358979323846;
-
-// DTMF Frequencies and Characters
-std::map<std::pair<int, int>, char> dtmfMap = {
-    {{697, 1209}, '1'}, {{697, 1336}, '2'}, {{697, 1477}, '3'},
-    {{770, 1209}, '4'}, {{770, 1336}, '5'}, {{770, 1477}, '6'},
-    {{852, 1209}, '7'}, {{852, 1336}, '8'}, {{852, 1477}, '9'},
-    {{941, 1209}, '*'}, {{941, 1336}, '0'}, {{941, 1477}, '#'}
-};
-
-// Perform FFT using FFTW
-std::vector<double> performFFT(const std::vector<sf::Int16>& samples) {
-    double* in = fftw_alloc_real(N);
-    fftw_complex* out = fftw_alloc_complex(N / 2 + 1);
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include "audioio.hpp"
+#include "sfmlaudio.hpp"
+#include "protocol.hpp"
+#include "receiver.hpp"
+#include "rtreceiver.hpp"
+#include "telemetry.hpp"
 
-    for (int i = 0; i < N; ++i) {
-        in[i] = (i < samples.size()) ? samples[i] : 0.0;
-    }
+const int SAMPLE_RATE = 44100;   // Capture sample rate
+const int QUEUE_SIZE = 65536;    // Capture queue (~1.5 s)
+const double TELEMETRY_INTERVAL = 10.0; // Seconds between telemetry dumps
+const double MAX_TONE_GAP = 1.0; // Seconds between tones of one message before it is dropped
+const double RT_REPORT_INTERVAL = 30.0; // --rt: seconds between worker timing reports
 
-    fftw_plan plan = fftw_plan_dft_r2c_1d(N, in, out, FFTW_ESTIMATE);
-    fftw_execute(plan);
+// Console output for the receiver.
+// Tones are reported when they start and fed to the message decoder (or the link
+// frame decoder in link mode), which reports each complete DTMF2 command; quiet or
+// non-DTMF input gets a status line at most every 3 seconds.
+class ConsoleReport {
+private:
+    std::chrono::steady_clock::time_point lastFeedbackTime;
+    int sampleRate;
+    CommandDecoder decoder;
+    LinkDecoder linkDecoder;
+    bool link;
 
-    std::vector<double> magnitudes(N / 2);
-    for (int i = 0; i < N / 2; ++i) {
-        magnitudes[i] = sqrt(out[i][0] * out[i][0] + out[i][1] * out[i][1]);
+public:
+    ConsoleReport(int sampleRate, bool link)
+        : sampleRate(sampleRate), decoder(static_cast<std::uint64_t>(MAX_TONE_GAP * sampleRate)),
+          linkDecoder(static_cast<std::uint64_t>(sampleRate) * LINK_MAX_GAP_MS / 1000), link(link) {
+        lastFeedbackTime = std::chrono::steady_clock::now();
     }
 
-    fftw_destroy_plan(plan);
-    fftw_free(in);
-    fftw_free(out);
+    void operator()(const ReceiverFrame& frame) {
+        if (frame.onset) {
+            std::cout << "Detected DTMF tone: " << frame.symbol << std::endl;
+            if (link) {
+                LinkFrame received;
+                if (linkDecoder.push(frame.symbol, frame.sampleIndex, received)) {
+                    std::cout << "Commands: " << received.commands << " (" << static_cast<double>(received.start) / sampleRate
+                              << " - " << static_cast<double>(received.end) / sampleRate << " s)" << std::endl;
+                }
+                return;
+            }
+            ReceivedCommand command;
+            if (decoder.push(frame.symbol, frame.sampleIndex, command)) {
+                std::cout << "Command: " << command.command << " (" << static_cast<double>(command.start) / sampleRate
+                          << " - " << static_cast<double>(command.end) / sampleRate << " s)" << std::endl;
+            }
+            return;
+        }
+        if (frame.symbol != '\0') return;
 
-    return magnitudes;
-}
+        // Provide periodic feedback about quiet and non-DTMF signals
+        auto now = std::chrono::steady_clock::now();
+        if (std::chrono::duration_cast<std::chrono::seconds>(now - lastFeedbackTime).count() < 3) return;
+        lastFeedbackTime = now;
 
-// Find the two strongest frequencies above 500 Hz
-std::pair<int, int> findStrongestFrequencies(const std::vector<double>& magnitudes) {
-    int peak1 = 0, peak2 = 0;
+        if (frame.quiet) {
+            std::cout << "Signal too quiet. RMS: " << sqrt(static_cast<double>(frame.energy) / frame.frameSize) << std::endl;
+        } else {
+            std::cout << "Strongest Frequencies: " << frame.strongest.first << " Hz, " << frame.strongest.second << " Hz\n";
+        }
+    }
+};
 
-    for (int i = 1; i < magnitudes.size(); ++i) {
-        int freq = i * SAMPLE_RATE / N;
-        if (freq < 500) continue; // Skip frequencies below 500 Hz
+// Telemetry settings from the command line; target is nullptr when it is off
+struct TelemetryOptions {
+    const char* target;
+    double interval;
+};
 
-        if (magnitudes[i] > magnitudes[peak1]) {
-            peak2 = peak1;
-            peak1 = i;
-        } else if (magnitudes[i] > magnitudes[peak2]) {
-            peak2 = i;
-        }
+// Decode a recording as fast as it can be read
+int runFile(const char* path, int hop, bool sliding, bool link, const TelemetryOptions& options) {
+    WavFileSource source(path);
+    if (!source.isOpen()) {
+        std::cerr << path << ": not a 16-bit PCM WAV file\n";
+        return -1;
     }
 
-    int freq1 = peak1 * SAMPLE_RATE / N;
-    int freq2 = peak2 * SAMPLE_RATE / N;
+    DTMFReceiver receiver(source.sampleRate(), hop, sliding);
+    ConsoleReport report(source.sampleRate(), link);
+    Telemetry telemetry;
+    if (options.target) receiver.setTelemetry(&telemetry);
+    receiver.poll(source, report);
 
-    return {freq1, freq2};
+    if (options.target && !TelemetryWriter(options.target).write(telemetry.format())) {
+        std::cerr << "Cannot write telemetry to " << options.target << "\n";
+    }
+    return 0;
 }
 
-// Match frequencies to DTMF characters
-char detectDTMF(const std::pair<int, int>& freqs) {
-    for (const auto& pair : dtmfMap) {
-        if ((std::abs(freqs.first - pair.first.first) < 20 && std::abs(freqs.second - pair.first.second) < 20) ||
-            (std::abs(freqs.first - pair.first.second) < 20 && std::abs(freqs.second - pair.first.first) < 20)) {
-            return pair.second;
+// Live capture: the SFML thread only fills the capture queue, this thread drains it
+int runLive(int hop, bool sliding, bool link, const TelemetryOptions& options) {
+    SfmlSource source(SAMPLE_RATE, QUEUE_SIZE);
+    DTMFReceiver receiver(SAMPLE_RATE, hop, sliding);
+    ConsoleReport report(SAMPLE_RATE, link);
+
+    Telemetry telemetry;
+    std::unique_ptr<TelemetryWriter> telemetryOut;
+    if (options.target) {
+        telemetryOut.reset(new TelemetryWriter(options.target));
+        if (!telemetryOut->isOpen()) {
+            std::cerr << "Cannot open telemetry target " << options.target << "\n";
+            return -1;
         }
+        source.setTelemetry(&telemetry);
+        receiver.setTelemetry(&telemetry);
     }
-    return '\0'; // No match found
-}
-
-// Custom recorder class
-class DTMFRecorder : public sf::SoundRecorder {
-private:
-    std::chrono::steady_clock::time_point lastFeedbackTime;
 
-public:
-    DTMFRecorder() {
-        lastFeedbackTime = std::chrono::steady_clock::now();
+    if (!source.start()) {
+        std::cerr << "Failed to start audio recording.\n";
+        return -1;
     }
 
-protected:
-    bool onProcessSamples(const sf::Int16* samples, std::size_t sampleCount) override {
-        if (sampleCount == 0) return true;
+    std::cout << "Listening for DTMF tones...\n";
+    std::size_t reportedOverruns = 0, maxQueueDepth = 0;
+    auto lastCheck = std::chrono::steady_clock::now();
+    auto lastDump = lastCheck;
+    while (true) {
+        std::size_t depth = source.getQueueDepth();
+        if (depth > maxQueueDepth) maxQueueDepth = depth;
 
-        // Calculate loudness (RMS)
-        double rms = 0.0;
-        for (std::size_t i = 0; i < sampleCount; ++i) {
-            rms += samples[i] * samples[i];
+        if (receiver.poll(source, report) == 0) {
+            sf::sleep(sf::milliseconds(5)); // Wait for the capture thread
         }
-        rms = sqrt(rms / sampleCount);
-
-        // Skip if signal is too quiet
-        if (rms < 1000) {
-            // Provide periodic feedback about quiet signals
-            auto now = std::chrono::steady_clock::now();
-            if (std::chrono::duration_cast<std::chrono::seconds>(now - lastFeedbackTime).count() >= 3) {
-                std::cout << "Signal too quiet. RMS: " << rms << std::endl;
-                lastFeedbackTime = now;
-            }
-            return true;
+
+        // Periodic telemetry dump
+        auto now = std::chrono::steady_clock::now();
+        if (telemetryOut && std::chrono::duration<double>(now - lastDump).count() >= options.interval) {
+            telemetryOut->write(telemetry.format());
+            lastDump = now;
         }
 
-        // Convert samples to vector
-        std::vector<sf::Int16> sampleVector(samples, samples + std::min(sampleCount, std::size_t(N)));
+        // Report when processing falls behind the capture thread
+        if (now - lastCheck < std::chrono::milliseconds(500)) continue;
+        lastCheck = now;
+        std::size_t overruns = source.getOverruns();
+        if (overruns != reportedOverruns) {
+            std::cerr << "Dropped " << overruns - reportedOverruns << " samples (queue depth "
+                      << source.getQueueDepth() << ", max " << maxQueueDepth << ")\n";
+            reportedOverruns = overruns;
+        }
+    }
 
-        // Perform FFT
-        std::vector<double> magnitudes = performFFT(sampleVector);
+    source.stop();
+    return 0;
+}
 
-        // Find strongest frequencies
-        std::pair<int, int> strongestFreqs = findStrongestFrequencies(magnitudes);
+// Live capture with detection on a real-time worker: this thread is the logger and
+// does the decoding and printing the worker must not
+int runRealtime(int hop, bool sliding, bool link, const RealtimeConfig& config, const TelemetryOptions& options) {
+    SfmlSource source(SAMPLE_RATE, QUEUE_SIZE);
+    RealtimeReceiver receiver(source, hop, sliding, config);
+    ConsoleReport report(SAMPLE_RATE, link);
 
-        // Detect DTMF tone
-        char detectedChar = detectDTMF(strongestFreqs);
-        if (detectedChar != '\0') {
-            std::cout << "Detected DTMF tone: " << detectedChar << std::endl;
-        } else {
-            // Provide periodic feedback about non-DTMF signals
-            auto now = std::chrono::steady_clock::now();
-            if (std::chrono::duration_cast<std::chrono::seconds>(now - lastFeedbackTime).count() >= 3) {
-                std::cout << "Strongest Frequencies: " << strongestFreqs.first << " Hz, " << strongestFreqs.second << " Hz\n";
-                lastFeedbackTime = now;
-            }
+    Telemetry telemetry;
+    std::unique_ptr<TelemetryWriter> telemetryOut;
+    if (options.target) {
+        telemetryOut.reset(new TelemetryWriter(options.target));
+        if (!telemetryOut->isOpen()) {
+            std::cerr << "Cannot open telemetry target " << options.target << "\n";
+            return -1;
         }
-
-        return true; // Continue recording
+        source.setTelemetry(&telemetry);
+        receiver.setTelemetry(&telemetry);
     }
-};
 
-int main() {
-    DTMFRecorder recorder;
-
-    if (!recorder.start(SAMPLE_RATE)) {
+    RealtimeStatus status = receiver.start();
+    std::cerr << status.warnings;
+    if (!source.start()) {
         std::cerr << "Failed to start audio recording.\n";
         return -1;
     }
 
-    std::cout << "Listening for DTMF tones...\n";
+    std::cout << "Listening for DTMF tones (memory " << (status.memoryLocked ? "locked" : "not locked") << ", "
+              << (status.pinned ? "pinned" : "not pinned") << ", " << (status.fifo ? "SCHED_FIFO" : "normal priority")
+              << ")...\n";
+    RealtimeEvent events[64];
+    std::size_t reportedOverruns = 0;
+    std::uint64_t reportedDrops = 0;
+    auto lastReport = std::chrono::steady_clock::now();
+    auto lastDump = lastReport;
     while (true) {
-        sf::sleep(sf::milliseconds(500));
+        std::size_t count = receiver.drain(events, 64);
+        for (std::size_t i = 0; i < count; ++i) report(toReceiverFrame(events[i]));
+        if (count == 0) sf::sleep(sf::milliseconds(20));
+
+        auto now = std::chrono::steady_clock::now();
+        if (telemetryOut && std::chrono::duration<double>(now - lastDump).count() >= options.interval) {
+            telemetryOut->write(telemetry.format());
+            lastDump = now;
+        }
+        std::size_t overruns = source.getOverruns();
+        std::uint64_t drops = receiver.getDroppedEvents();
+        if (overruns != reportedOverruns || drops != reportedDrops) {
+            std::cerr << "Dropped " << overruns - reportedOverruns << " samples, " << drops - reportedDrops
+                      << " events\n";
+            reportedOverruns = overruns;
+            reportedDrops = drops;
+        }
+        if (std::chrono::duration<double>(now - lastReport).count() < RT_REPORT_INTERVAL) continue;
+        lastReport = now;
+        const TelemetryHistogram& processing = receiver.getProcessing();
+        const TelemetryHistogram& lateness = receiver.getWakeLateness();
+        std::cout << "Worker: processing p99 < " << processing.quantile(0.99) / 1000 << " us, max "
+                  << processing.getMax() / 1000 << " us; wake-up lateness p99 < " << lateness.quantile(0.99) / 1000
+                  << " us, max " << lateness.getMax() / 1000 << " us\n";
     }
 
-    recorder.stop();
+    source.stop();
     return 0;
 }
 
-// g++ DTMF5.cpp -o DTMF5 -I/opt/homebrew/opt/sfml/include -I/opt/homebrew/include -L/opt/homebrew/opt/sfml/lib -L/opt/homebrew/lib -lsfml-audio -lsfml-system -lsfml-window -lfftw3 -std=c++11
\ No newline at end of file
+int main(int argc, char* argv[]) {
+    // DTMF5 [--sliding] [--link] [--wav FILE] [--telemetry FILE|unix:PATH] [--telemetry-interval SECONDS]
+    //       [--rt [--cpu N] [--priority P]] [hop]
+    // --rt runs detection on a worker with locked memory and SCHED_FIFO priority P
+    // (default 80), optionally pinned to CPU N; without privileges it says what it
+    // could not set and carries on
+    bool sliding = false, link = false, rt = false;
+    RealtimeConfig realtime = {true, -1, RT_DEFAULT_PRIORITY};
+    const char* wavPath = nullptr;
+    TelemetryOptions telemetry = {nullptr, TELEMETRY_INTERVAL};
+    int hop = RECEIVER_HOP;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--sliding") == 0) sliding = true;
+        else if (std::strcmp(argv[i], "--link") == 0) link = true;
+        else if (std::strcmp(argv[i], "--wav") == 0 && i + 1 < argc) wavPath = argv[++i];
+        else if (std::strcmp(argv[i], "--telemetry") == 0 && i + 1 < argc) telemetry.target = argv[++i];
+        else if (std::strcmp(argv[i], "--telemetry-interval") == 0 && i + 1 < argc) telemetry.interval = std::atof(argv[++i]);
+        else if (std::strcmp(argv[i], "--rt") == 0) rt = true;
+        else if (std::strcmp(argv[i], "--cpu") == 0 && i + 1 < argc) realtime.cpu = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--priority") == 0 && i + 1 < argc) realtime.priority = std::atoi(argv[++i]);
+        else hop = std::atoi(argv[i]);
+    }
+    if (hop <= 0 || hop > RECEIVER_FRAME) {
+        std::cerr << "Hop must be between 1 and " << RECEIVER_FRAME << " samples.\n";
+        return -1;
+    }
+
+    sliding = receiverSliding(sliding, link);
+
+    if (wavPath) return runFile(wavPath, hop, sliding, link, telemetry);
+    if (rt) return runRealtime(hop, sliding, link, realtime, telemetry);
+    return runLive(hop, sliding, link, telemetry);
+}
+
+// g++ DTMF5.cpp -o DTMF5 -I/opt/homebrew/opt/sfml/include -L/opt/homebrew/opt/sfml/lib -lsfml-audio -lsfml-system -lsfml-window -std=c++17
+
+// Add -DDTMF_FIXED_POINT for the integer-only frame detector
\ No newline at end of file
@@ -0,0 +1,228 @@
+#ifndef AUDIOIO_HPP
+#define AUDIOIO_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+#include "wavfile.hpp"
+
+// Where the programs get audio from and send it to. Sources and sinks carry
+// mono 16-bit samples; the device-backed implementations live in sfmlaudio.hpp,
+// so everything here builds without SFML.
+
+class AudioSource {
+public:
+    virtual ~AudioSource() {}
+
+    // Copy up to count samples that are available now; never blocks. 0 means nothing
+    // is ready (or, if finished(), that the stream has ended).
+    virtual std::size_t read(std::int16_t* samples, std::size_t count) = 0;
+
+    virtual int sampleRate() const = 0;
+
+    // True once a finite source has delivered everything
+    virtual bool finished() const {
+        return false;
+    }
+};
+
+class AudioSink {
+public:
+    virtual ~AudioSink() {}
+
+    // Queue samples for output; false if the sink failed
+    virtual bool write(const std::int16_t* samples, std::size_t count) = 0;
+
+    virtual int sampleRate() const = 0;
+
+    // Cut a write that is still playing short; may be called from another thread.
+    // Sinks whose writes return straight away ignore it. The flag sticks, so a write
+    // that starts after it returns at once too, until clearInterrupt().
+    virtual void interrupt() {}
+
+    virtual void clearInterrupt() {}
+};
+
+// In-memory loopback: whatever is written can be read back straight away.
+// Nothing is paced by a clock, so a transmitter and receiver connected through it
+// run as fast as the CPU allows. Optional white noise models the acoustic path.
+// Not thread-safe: write and read from the same thread.
+class LoopbackAudio : public AudioSink, public AudioSource {
+public:
+    explicit LoopbackAudio(int sampleRate, double noiseRms = 0.0, unsigned seed = 1)
+        : rate(sampleRate), noiseRms(noiseRms), position(0), rng(seed), noise(0.0, noiseRms > 0.0 ? noiseRms : 1.0) {}
+
+    bool write(const std::int16_t* samples, std::size_t count) override {
+        // Drop what has been read before growing
+        if (position > 0 && position >= buffer.size() / 2) {
+            buffer.erase(buffer.begin(), buffer.begin() + position);
+            position = 0;
+        }
+        std::size_t start = buffer.size();
+        buffer.insert(buffer.end(), samples, samples + count);
+        if (noiseRms > 0.0) {
+            for (std::size_t i = start; i < buffer.size(); ++i) {
+                double x = buffer[i] + noise(rng);
+                buffer[i] = static_cast<std::int16_t>(x > 32767.0 ? 32767.0 : (x < -32768.0 ? -32768.0 : x));
+            }
+        }
+        return true;
+    }
+
+    // Append count samples of silence
+    void writeSilence(std::size_t count) {
+        std::vector<std::int16_t> silence(count, 0);
+        write(silence.data(), count);
+    }
+
+    std::size_t read(std::int16_t* samples, std::size_t count) override {
+        std::size_t available = buffer.size() - position;
+        if (count > available) count = available;
+        std::copy(buffer.begin() + position, buffer.begin() + position + count, samples);
+        position += count;
+        return count;
+    }
+
+    int sampleRate() const override {
+        return rate;
+    }
+
+    // Samples written but not read yet
+    std::size_t pending() const {
+        return buffer.size() - position;
+    }
+
+private:
+    int rate;
+    double noiseRms;
+    std::vector<std::int16_t> buffer;
+    std::size_t position; // Next sample to read
+    std::mt19937 rng;
+    std::normal_distribution<double> noise;
+};
+
+// Whole WAV file loaded into memory; one channel of it is played back
+class WavFileSource : public AudioSource {
+public:
+    explicit WavFileSource(const std::string& path, int channel = 0) : rate(0), position(0) {
+        std::ifstream file(path, std::ios::binary);
+        std::vector<unsigned char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+        WavInfo info;
+        if (!parseWavHeader(data.data(), data.size(), info) || channel < 0 || channel >= info.channels) return;
+        rate = info.sampleRate;
+        std::size_t frames = info.dataSize / (sizeof(std::int16_t) * info.channels);
+        samples.resize(frames);
+        const unsigned char* p = data.data() + info.dataOffset + channel * sizeof(std::int16_t);
+        for (std::size_t i = 0; i < frames; ++i, p += sizeof(std::int16_t) * info.channels) {
+            samples[i] = static_cast<std::int16_t>(readLE16(p));
+        }
+    }
+
+    // False if the file could not be read or is not 16-bit PCM
+    bool isOpen() const {
+        return rate > 0;
+    }
+
+    std::size_t read(std::int16_t* out, std::size_t count) override {
+        std::size_t available = samples.size() - position;
+        if (count > available) count = available;
+        std::copy(samples.begin() + position, samples.begin() + position + count, out);
+        position += count;
+        return count;
+    }
+
+    int sampleRate() const override {
+        return rate;
+    }
+
+    bool finished() const override {
+        return position == samples.size();
+    }
+
+private:
+    int rate;
+    std::vector<std::int16_t> samples;
+    std::size_t position;
+};
+
+// Mono 16-bit WAV writer. The header sizes are filled in when the file is closed.
+class WavFileSink : public AudioSink {
+public:
+    WavFileSink(const std::string& path, int sampleRate) : rate(sampleRate), dataBytes(0) {
+        file = std::fopen(path.c_str(), "wb");
+        if (file) writeHeader();
+    }
+
+    ~WavFileSink() {
+        close();
+    }
+
+    bool isOpen() const {
+        return file != nullptr;
+    }
+
+    bool write(const std::int16_t* samples, std::size_t count) override {
+        if (!file) return false;
+        bytes.resize(count * 2);
+        for (std::size_t i = 0; i < count; ++i) {
+            bytes[2 * i] = static_cast<unsigned char>(samples[i] & 0xFF);
+            bytes[2 * i + 1] = static_cast<unsigned char>((samples[i] >> 8) & 0xFF);
+        }
+        if (std::fwrite(bytes.data(), 1, bytes.size(), file) != bytes.size()) return false;
+        dataBytes += bytes.size();
+        return true;
+    }
+
+    int sampleRate() const override {
+        return rate;
+    }
+
+    void close() {
+        if (!file) return;
+        std::fseek(file, 0, SEEK_SET);
+        writeHeader();
+        std::fclose(file);
+        file = nullptr;
+    }
+
+private:
+    WavFileSink(const WavFileSink&);
+    WavFileSink& operator=(const WavFileSink&);
+
+    static void putLE32(unsigned char* p, std::uint32_t v) {
+        p[0] = v & 0xFF;
+        p[1] = (v >> 8) & 0xFF;
+        p[2] = (v >> 16) & 0xFF;
+        p[3] = (v >> 24) & 0xFF;
+    }
+
+    void writeHeader() {
+        unsigned char header[44];
+        std::memcpy(header, "RIFF", 4);
+        putLE32(header + 4, static_cast<std::uint32_t>(36 + dataBytes));
+        std::memcpy(header + 8, "WAVEfmt ", 8);
+        putLE32(header + 16, 16);
+        putLE32(header + 20, 1 | (1 << 16));                  // PCM, mono
+        putLE32(header + 24, static_cast<std::uint32_t>(rate));
+        putLE32(header + 28, static_cast<std::uint32_t>(rate * 2)); // Byte rate
+        putLE32(header + 32, 2 | (16 << 16));                 // Block align, bits per sample
+        std::memcpy(header + 36, "data", 4);
+        putLE32(header + 40, static_cast<std::uint32_t>(dataBytes));
+        std::fwrite(header, 1, sizeof(header), file);
+    }
+
+    std::FILE* file;
+    int rate;
+    std::size_t dataBytes;
+    std::vector<unsigned char> bytes; // Little-endian staging for write()
+};
+
+#endif
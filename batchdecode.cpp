@@ -0,0 +1,261 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "goertzel.hpp"
+#include "wavfile.hpp"
+#include "decimator.hpp"
+
+const double FRAME_SECONDS = 0.025;   // Analysis frame (same bandwidth as the live receivers)
+const double MIN_TONE_SECONDS = 0.04; // Shorter detections are dropped
+const double MAX_GAP_SECONDS = 0.02;  // Dropouts up to this long inside one tone are bridged
+const std::size_t CHUNK_FRAMES = 8192; // Frames per work item
+
+// Read-only memory mapping of a whole file
+class MappedFile {
+public:
+    explicit MappedFile(const char* path) : data(nullptr), size(0) {
+        int fd = open(path, O_RDONLY);
+        if (fd < 0) return;
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED) {
+                data = static_cast<const unsigned char*>(p);
+                size = st.st_size;
+                madvise(p, size, MADV_SEQUENTIAL);
+            }
+        }
+        close(fd);
+    }
+
+    ~MappedFile() {
+        if (data) munmap(const_cast<unsigned char*>(data), size);
+    }
+
+    // Give pages back once they have been decoded so resident memory stays flat
+    void release(std::size_t offset, std::size_t length) const {
+        long page = sysconf(_SC_PAGESIZE);
+        std::size_t start = (offset + page - 1) / page * page;
+        std::size_t end = (offset + length) / page * page;
+        if (end > start) madvise(const_cast<unsigned char*>(data) + start, end - start, MADV_DONTNEED);
+    }
+
+    const unsigned char* data;
+    std::size_t size;
+
+private:
+    MappedFile(const MappedFile&);
+    MappedFile& operator=(const MappedFile&);
+};
+
+// Consecutive frames that detected the same symbol
+struct ToneRun {
+    std::size_t startFrame;
+    std::size_t endFrame; // One past the last frame
+    char symbol;
+};
+
+struct Stream {
+    const std::int16_t* samples;
+    std::size_t sampleCount; // Per channel, at sampleRate
+    int channels;
+    int channel;
+    int sampleRate;          // Analysis rate
+    std::size_t frameSize;
+    std::size_t hop;
+    const Decimator* decimator; // Set when the file rate differs from sampleRate
+    std::size_t inputCount;     // Per channel, at the file rate
+};
+
+// Decode frames [firstFrame, lastFrame). Frames near the end read past the
+// chunk into the next one, so no tone is lost at chunk boundaries.
+std::vector<ToneRun> decodeChunk(const Stream& stream, std::size_t firstFrame, std::size_t lastFrame) {
+    GoertzelDetector detector(stream.sampleRate);
+    std::vector<std::int16_t> scratch(stream.frameSize);
+    std::vector<ToneRun> runs;
+
+    // Decimate just the span this chunk covers; the filter reads its own history
+    // from the mapping, so chunks stay independent
+    std::vector<std::int16_t> decimated;
+    std::size_t spanStart = firstFrame * stream.hop;
+    if (stream.decimator) {
+        decimated.resize((lastFrame - 1 - firstFrame) * stream.hop + stream.frameSize);
+        stream.decimator->processRange(stream.samples + stream.channel, stream.inputCount, spanStart,
+                                       decimated.size(), decimated.data(), stream.channels);
+    }
+
+    for (std::size_t f = firstFrame; f < lastFrame; ++f) {
+        const std::int16_t* frame = stream.samples + f * stream.hop * stream.channels;
+        if (stream.decimator) {
+            frame = decimated.data() + (f * stream.hop - spanStart);
+        } else if (stream.channels > 1) {
+            for (std::size_t n = 0; n < stream.frameSize; ++n) {
+                scratch[n] = frame[n * stream.channels + stream.channel];
+            }
+            frame = scratch.data();
+        }
+
+        char symbol = detector.detect(frame, stream.frameSize);
+        if (symbol == '\0') continue;
+
+        if (!runs.empty() && runs.back().endFrame == f && runs.back().symbol == symbol) {
+            runs.back().endFrame = f + 1;
+        } else {
+            ToneRun run = {f, f + 1, symbol};
+            runs.push_back(run);
+        }
+    }
+    return runs;
+}
+
+// Join per-chunk runs in order: merge runs split by a chunk boundary or a short
+// dropout, then drop anything too short to be a real tone
+std::vector<ToneRun> stitch(const std::vector<std::vector<ToneRun> >& chunkRuns,
+                            std::size_t maxGapFrames, std::size_t minFrames) {
+    std::vector<ToneRun> merged;
+    for (const auto& runs : chunkRuns) {
+        for (const ToneRun& run : runs) {
+            if (!merged.empty() && merged.back().symbol == run.symbol &&
+                run.startFrame <= merged.back().endFrame + maxGapFrames) {
+                merged.back().endFrame = run.endFrame;
+            } else {
+                merged.push_back(run);
+            }
+        }
+    }
+
+    std::vector<ToneRun> tones;
+    for (const ToneRun& run : merged) {
+        if (run.endFrame - run.startFrame >= minFrames) tones.push_back(run);
+    }
+    return tones;
+}
+
+int decodeFile(const char* path, bool raw, int rawRate, int channel, int decimateRate, unsigned threadCount) {
+    MappedFile file(path);
+    if (!file.data) {
+        std::cerr << "Cannot map " << path << "\n";
+        return -1;
+    }
+
+    WavInfo info = {rawRate, 1, 0, file.size};
+    if (!raw && !parseWavHeader(file.data, file.size, info)) {
+        std::cerr << path << ": not a 16-bit PCM WAV file (use --raw for headerless PCM)\n";
+        return -1;
+    }
+    if (channel < 0 || channel >= info.channels) {
+        std::cerr << path << ": channel " << channel << " out of range\n";
+        return -1;
+    }
+
+    Stream stream;
+    stream.samples = reinterpret_cast<const std::int16_t*>(file.data + info.dataOffset);
+    stream.channels = info.channels;
+    stream.channel = channel;
+    stream.inputCount = info.dataSize / (sizeof(std::int16_t) * info.channels);
+    stream.sampleCount = stream.inputCount;
+    stream.sampleRate = info.sampleRate;
+    stream.decimator = nullptr;
+
+    // Optionally analyse at a lower rate: same frame duration, fewer samples per frame
+    Decimator decimator(info.sampleRate, decimateRate > 0 ? decimateRate : info.sampleRate);
+    if (decimateRate > 0 && decimateRate < info.sampleRate) {
+        stream.decimator = &decimator;
+        stream.sampleRate = decimateRate;
+        stream.sampleCount = static_cast<std::size_t>(static_cast<std::uint64_t>(stream.inputCount) * decimateRate / info.sampleRate);
+    }
+    stream.frameSize = static_cast<std::size_t>(FRAME_SECONDS * stream.sampleRate);
+    stream.hop = stream.frameSize / 2;
+
+    std::size_t frameCount = stream.sampleCount >= stream.frameSize
+        ? (stream.sampleCount - stream.frameSize) / stream.hop + 1 : 0;
+    std::size_t chunkCount = (frameCount + CHUNK_FRAMES - 1) / CHUNK_FRAMES;
+    std::vector<std::vector<ToneRun> > chunkRuns(chunkCount);
+    std::atomic<std::size_t> nextChunk(0);
+
+    auto start = std::chrono::steady_clock::now();
+
+    // Workers pull chunks in file order, so finished pages can be released behind them
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threadCount; ++t) {
+        workers.push_back(std::thread([&]() {
+            std::size_t chunk;
+            while ((chunk = nextChunk++) < chunkCount) {
+                std::size_t first = chunk * CHUNK_FRAMES;
+                std::size_t last = std::min(first + CHUNK_FRAMES, frameCount);
+                chunkRuns[chunk] = decodeChunk(stream, first, last);
+
+                double bytesPerFrame = static_cast<double>(stream.hop) * info.sampleRate / stream.sampleRate *
+                                       stream.channels * sizeof(std::int16_t);
+                file.release(info.dataOffset + static_cast<std::size_t>(first * bytesPerFrame),
+                             static_cast<std::size_t>((last - first) * bytesPerFrame));
+            }
+        }));
+    }
+    for (auto& worker : workers) worker.join();
+
+    std::size_t maxGapFrames = static_cast<std::size_t>(MAX_GAP_SECONDS * stream.sampleRate / stream.hop);
+    std::size_t minFrames = static_cast<std::size_t>(MIN_TONE_SECONDS * stream.sampleRate / stream.hop);
+    std::vector<ToneRun> tones = stitch(chunkRuns, maxGapFrames, minFrames > 0 ? minFrames : 1);
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double audioSeconds = static_cast<double>(stream.inputCount) / info.sampleRate;
+
+    // Timestamped symbol log: start, end (seconds), symbol
+    for (const ToneRun& tone : tones) {
+        double begin = static_cast<double>(tone.startFrame * stream.hop) / stream.sampleRate;
+        double end = static_cast<double>((tone.endFrame - 1) * stream.hop + stream.frameSize) / stream.sampleRate;
+        std::printf("%.3f\t%.3f\t%c\n", begin, end, tone.symbol);
+    }
+
+    std::cerr << path << ": " << tones.size() << " tones in " << audioSeconds << " s of audio, decoded in "
+              << elapsed << " s (" << audioSeconds / elapsed << "x real time, " << threadCount << " threads)\n";
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    bool raw = false;
+    int rawRate = 8000;
+    int channel = 0;
+    int decimateRate = 0;
+    int threadCount = static_cast<int>(std::thread::hardware_concurrency());
+    if (threadCount == 0) threadCount = 1;
+
+    std::vector<const char*> files;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--raw") == 0) raw = true;
+        else if (std::strcmp(argv[i], "--rate") == 0 && i + 1 < argc) rawRate = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--channel") == 0 && i + 1 < argc) channel = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--decimate") == 0 && i + 1 < argc) decimateRate = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) threadCount = std::atoi(argv[++i]);
+        else files.push_back(argv[i]);
+    }
+
+    if (files.empty() || rawRate <= 0) {
+        std::cerr << "Usage: batchdecode [--raw --rate HZ] [--channel C] [--decimate HZ] [--threads T] file...\n";
+        return -1;
+    }
+    if (threadCount < 1 || threadCount > 1024) {
+        std::cerr << "Threads must be 1-1024\n";
+        return -1;
+    }
+
+    int status = 0;
+    for (const char* path : files) {
+        if (files.size() > 1) std::printf("# %s\n", path);
+        if (decodeFile(path, raw, rawRate, channel, decimateRate, threadCount) != 0) status = -1;
+    }
+    return status;
+}
+
+// g++ batchdecode.cpp -o batchdecode -O2 -pthread -std=c++17
@@ -0,0 +1,1041 @@
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <chrono>
+#include <cstdlib>
+#include <cstdint>
+#include <random>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include "goertzel.hpp"
+#include "multichannel.hpp"
+#include "synth.hpp"
+#include "decimator.hpp"
+#include "slidingdft.hpp"
+#include "fftworkspace.hpp"
+#include "fftdetector.hpp"
+#include "fixedpoint.hpp"
+#include "kernels.hpp"
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+const double PI = 3.14159265358979323846;
+const int AMPLITUDE = 12000;
+const double SECONDS = 4.0;     // Audio per channel
+const double TONE_ON = 0.1;     // Tone and pause length of the test pattern
+const double TONE_OFF = 0.1;
+
+// Channel-interleaved test signal: every channel keys its own symbol on and off
+std::vector<std::int16_t> makeInterleavedSignal(int channels, int sampleRate, std::size_t frames) {
+    std::vector<std::int16_t> samples(frames * channels);
+    std::size_t period = static_cast<std::size_t>((TONE_ON + TONE_OFF) * sampleRate);
+    std::size_t onLength = static_cast<std::size_t>(TONE_ON * sampleRate);
+
+    for (int c = 0; c < channels; ++c) {
+        int row = c % 4, col = (c / 4) % 4;
+        for (std::size_t i = 0; i < frames; ++i) {
+            double sample = 0.0;
+            if (i % period < onLength) {
+                sample = 0.5 * (sin(2 * PI * DTMF_ROW_FREQS[row] * i / sampleRate) +
+                                sin(2 * PI * DTMF_COL_FREQS[col] * i / sampleRate));
+            }
+            samples[i * channels + c] = static_cast<std::int16_t>(AMPLITUDE * sample);
+        }
+    }
+    return samples;
+}
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void report(const char* name, int channels, double audioSeconds, double wallSeconds, std::size_t events) {
+    std::cout << name << ": " << wallSeconds * 1000.0 << " ms, "
+              << channels * audioSeconds / wallSeconds << " channels per core in real time, "
+              << events << " symbol events\n";
+}
+
+// Baseline: one scalar GoertzelDetector per channel, as DTMFRecorder runs it
+void benchIndependent(const std::vector<std::int16_t>& interleaved, int channels, int sampleRate,
+                      int blockSize, std::size_t frames) {
+    std::vector<GoertzelDetector> detectors(channels, GoertzelDetector(sampleRate));
+    std::vector<char> lastSymbol(channels, '\0');
+    std::vector<std::int16_t> block(blockSize);
+    std::size_t events = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t f = 0; f + blockSize <= frames; f += blockSize) {
+        for (int c = 0; c < channels; ++c) {
+            for (int n = 0; n < blockSize; ++n) block[n] = interleaved[(f + n) * channels + c];
+            char symbol = detectors[c].detect(block.data(), blockSize);
+            if (symbol != '\0' && symbol != lastSymbol[c]) ++events;
+            lastSymbol[c] = symbol;
+        }
+    }
+    report("independent scalar detectors", channels, SECONDS, secondsSince(start), events);
+}
+
+void benchMultiChannel(const std::vector<std::int16_t>& interleaved, int channels, int sampleRate,
+                       int blockSize, std::size_t frames, KernelType kernelType) {
+    MultiChannelDetector detector(sampleRate, channels, blockSize, GoertzelThresholds(), kernelType);
+    std::vector<SymbolEvent> events;
+    events.reserve(channels * 64);
+
+    auto start = std::chrono::steady_clock::now();
+    detector.processInterleaved(interleaved.data(), frames, events);
+    double elapsed = secondsSince(start);
+
+    std::string name = std::string("multichannel ") + detector.instructionSet();
+    report(name.c_str(), channels, SECONDS, elapsed, events.size());
+}
+
+// Reference: the per-sample sin() generator from DTMF1/DTMF2
+void generateDTMFToneLegacy(int freq1, int freq2, int sampleRate, std::vector<std::int16_t>& samples, double durationInSeconds) {
+    double sampleCount = sampleRate * durationInSeconds;
+    samples.resize(sampleCount);
+
+    for (int i = 0; i < sampleCount; ++i) {
+        double sample = 0.5 * (sin(2 * PI * freq1 * i / sampleRate) +
+                               sin(2 * PI * freq2 * i / sampleRate));
+        samples[i] = static_cast<std::int16_t>(AMPLITUDE * sample);
+    }
+}
+
+void reportRate(const char* name, double samples, double wallSeconds) {
+    std::cout << name << ": " << samples / wallSeconds / 1e6 << " Msamples/s\n";
+}
+
+// Tone generation: sin() per sample against the precomputed tables
+void benchSynthesis(int sampleRate) {
+    const double duration = 0.4; // DTMF2 tone length
+    const int rounds = 64;       // Key presses per generator
+    std::size_t count = static_cast<std::size_t>(duration * sampleRate);
+    std::vector<std::int16_t> samples(count), reference;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; ++i) {
+        generateDTMFToneLegacy(DTMF_ROW_FREQS[i % 4], DTMF_COL_FREQS[(i / 4) % 4], sampleRate, reference, duration);
+    }
+    reportRate("legacy generateDTMFTone", double(rounds) * count, secondsSince(start));
+
+    start = std::chrono::steady_clock::now();
+    DTMFSynth synth(sampleRate, AMPLITUDE);
+    std::cout << "synth table setup: " << secondsSince(start) * 1000.0 << " ms\n";
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; ++i) {
+        std::size_t phase = 0;
+        synth.render(i % 4, (i / 4) % 4, samples.data(), count, phase);
+    }
+    reportRate("synth render", double(rounds) * count, secondsSince(start));
+
+    // The last round of both generators played the same symbol from phase 0
+    std::size_t mismatches = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        if (std::abs(samples[i] - reference[i]) > 1) ++mismatches;
+    }
+    std::cout << "synth samples differing from legacy: " << mismatches << "\n";
+}
+
+// Frame-by-frame detection over a mono stream, hop = half a frame; returns symbol changes
+template <typename Kernel>
+std::size_t detectFrames(Kernel& kernel, const std::int16_t* samples, std::size_t count) {
+    std::size_t events = 0;
+    char last = '\0';
+    for (std::size_t f = 0; f + Kernel::frameSize <= count; f += Kernel::frameSize / 2) {
+        char symbol = kernel.detect(samples + f);
+        if (symbol != '\0' && symbol != last) ++events;
+        last = symbol;
+    }
+    return events;
+}
+
+// Capture-rate audio straight into the detector, against decimating to 8 kHz first
+// (same ~25 ms frames, ~5x fewer samples to analyse)
+template <typename CaptureKernel>
+void benchDecimation() {
+    const int captureRate = CaptureKernel::sampleRate;
+    const int rounds = 8;
+    std::size_t frames = static_cast<std::size_t>(SECONDS * captureRate);
+    std::vector<std::int16_t> capture = makeInterleavedSignal(1, captureRate, frames);
+
+    CaptureKernel direct;
+    std::size_t directEvents = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; ++i) directEvents = detectFrames(direct, capture.data(), frames);
+    double directSeconds = secondsSince(start) / rounds;
+
+    // Streamed through the decimator in capture-callback sized pieces
+    const std::size_t callback = 1024;
+    Decimator decimator(captureRate, 8000);
+    std::vector<std::int16_t> decimated(decimator.outputCapacity(frames));
+    std::size_t decimatedCount = 0;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; ++i) {
+        decimatedCount = 0;
+        for (std::size_t f = 0; f < frames; f += callback) {
+            std::size_t n = frames - f < callback ? frames - f : callback;
+            decimatedCount += decimator.process(&capture[f], n, &decimated[decimatedCount]);
+        }
+    }
+    double decimateSeconds = secondsSince(start) / rounds;
+
+    GoertzelKernel8k reduced;
+    std::size_t reducedEvents = 0;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; ++i) reducedEvents = detectFrames(reduced, decimated.data(), decimatedCount);
+    double reducedSeconds = secondsSince(start) / rounds;
+
+    std::cout << captureRate << " Hz direct (" << CaptureKernel::frameSize << "-sample frames): "
+              << directSeconds * 1000.0 << " ms, " << directEvents << " symbol events\n";
+    std::cout << captureRate << " Hz -> 8000 Hz decimation (" << decimator.getTapsPerPhase() << " taps/output): "
+              << decimateSeconds * 1000.0 << " ms\n";
+    std::cout << "8000 Hz detection (205-sample frames): " << reducedSeconds * 1000.0 << " ms, "
+              << reducedEvents << " symbol events\n";
+    std::cout << "decimate + detect: " << directSeconds / (decimateSeconds + reducedSeconds)
+              << "x faster than direct\n";
+}
+
+// A tone burst in the latency test signal
+struct ToneOnset {
+    std::size_t start; // Sample index
+    char symbol;
+};
+
+// Decision reported by a detector path, timed at the sample it became available
+struct Decision {
+    std::size_t sample;
+    char symbol;
+};
+
+// Random symbols with noise, onsets at known samples
+std::vector<std::int16_t> makeLatencySignal(int sampleRate, int tones, double toneSeconds, double gapSeconds,
+                                            std::vector<ToneOnset>& onsets) {
+    std::size_t toneLength = static_cast<std::size_t>(toneSeconds * sampleRate);
+    std::size_t period = toneLength + static_cast<std::size_t>(gapSeconds * sampleRate);
+    std::vector<std::int16_t> samples(tones * period + sampleRate / 4);
+    std::mt19937 rng(7);
+    std::normal_distribution<double> noise(0.0, 300.0);
+    std::size_t offset = sampleRate / 10;
+
+    for (int t = 0; t < tones; ++t) {
+        int row = rng() % 4, col = rng() % 4;
+        std::size_t start = offset + t * period + rng() % 64; // Onsets do not line up with any block grid
+        ToneOnset onset = {start, DTMF_SYMBOLS[row][col]};
+        onsets.push_back(onset);
+        for (std::size_t i = 0; i < toneLength; ++i) {
+            double phase = static_cast<double>(i) / sampleRate;
+            samples[start + i] = static_cast<std::int16_t>(AMPLITUDE * 0.5 * (sin(2 * PI * DTMF_ROW_FREQS[row] * phase) +
+                                                                              sin(2 * PI * DTMF_COL_FREQS[col] * phase)));
+        }
+    }
+    for (std::int16_t& sample : samples) sample = static_cast<std::int16_t>(sample + noise(rng));
+    return samples;
+}
+
+// Time from each onset to the first matching decision before the next onset
+void reportLatency(const char* name, const std::vector<ToneOnset>& onsets, const std::vector<Decision>& decisions,
+                   int sampleRate) {
+    std::vector<double> latencies;
+    std::size_t d = 0;
+    for (std::size_t t = 0; t < onsets.size(); ++t) {
+        std::size_t end = t + 1 < onsets.size() ? onsets[t + 1].start : static_cast<std::size_t>(-1);
+        while (d < decisions.size() && decisions[d].sample < onsets[t].start) ++d;
+        for (std::size_t i = d; i < decisions.size() && decisions[i].sample < end; ++i) {
+            if (decisions[i].symbol == onsets[t].symbol) {
+                latencies.push_back(1000.0 * (decisions[i].sample - onsets[t].start) / sampleRate);
+                break;
+            }
+        }
+    }
+
+    std::cout << name << ": ";
+    if (latencies.empty()) {
+        std::cout << "no tones detected\n";
+        return;
+    }
+    std::sort(latencies.begin(), latencies.end());
+    double mean = 0.0;
+    for (double latency : latencies) mean += latency;
+    std::cout << "time-to-detect mean " << mean / latencies.size() << " ms, median "
+              << latencies[latencies.size() / 2] << " ms, max " << latencies.back() << " ms, "
+              << onsets.size() - latencies.size() << "/" << onsets.size() << " missed\n";
+}
+
+// Block Goertzel at the capture rate; a decision exists once the block is complete
+std::vector<Decision> blockGoertzelDecisions(const std::vector<std::int16_t>& samples, int sampleRate,
+                                             std::size_t blockSize, std::size_t hop) {
+    GoertzelDetector detector(sampleRate);
+    std::vector<Decision> decisions;
+    for (std::size_t f = 0; f + blockSize <= samples.size(); f += hop) {
+        char symbol = detector.detect(&samples[f], blockSize);
+        if (symbol != '\0') {
+            Decision decision = {f + blockSize, symbol};
+            decisions.push_back(decision);
+        }
+    }
+    return decisions;
+}
+
+// DTMF4's findStrongestFrequencies: the two largest bins, in Hz
+std::pair<int, int> findStrongestFrequencies(const std::vector<double>& magnitudes, int sampleRate) {
+    std::size_t peak1 = 0, peak2 = 0;
+    for (std::size_t i = 1; i < magnitudes.size(); ++i) {
+        if (magnitudes[i] > magnitudes[peak1]) {
+            peak2 = peak1;
+            peak1 = i;
+        } else if (magnitudes[i] > magnitudes[peak2]) {
+            peak2 = i;
+        }
+    }
+    std::size_t frameSize = 2 * magnitudes.size();
+    return std::make_pair(static_cast<int>(peak1 * sampleRate / frameSize), static_cast<int>(peak2 * sampleRate / frameSize));
+}
+
+// DTMF4's path: FFT magnitudes, two strongest bins, frequency table lookup
+std::vector<Decision> blockFFTDecisions(const std::vector<std::int16_t>& samples, int sampleRate,
+                                        std::size_t frameSize, std::size_t hop) {
+    FFTWorkspace fft(static_cast<int>(frameSize), "", FFTW_ESTIMATE);
+    std::vector<Decision> decisions;
+    for (std::size_t f = 0; f + frameSize <= samples.size(); f += hop) {
+        std::pair<int, int> peaks = findStrongestFrequencies(fft.transform(&samples[f], frameSize), sampleRate);
+        char symbol = dtmfSymbolAt(peaks.first, peaks.second);
+        if (symbol != '\0') {
+            Decision decision = {f + frameSize, symbol};
+            decisions.push_back(decision);
+        }
+    }
+    return decisions;
+}
+
+// Decimate to 8 kHz and run the sliding DFT; decision times are mapped back to the capture rate
+std::vector<Decision> slidingDecisions(const std::vector<std::int16_t>& samples, int sampleRate,
+                                       int windowSize, int minDuration, double& wallSeconds) {
+    const int detectRate = 8000;
+    Decimator decimator(sampleRate, detectRate);
+    SlidingDFTDetector detector(detectRate, windowSize, minDuration);
+    std::vector<std::int16_t> decimated(decimator.outputCapacity(samples.size()));
+    std::vector<Decision> decisions;
+
+    auto start = std::chrono::steady_clock::now();
+    std::size_t count = decimator.process(samples.data(), samples.size(), decimated.data());
+    for (std::size_t n = 0; n < count; ++n) {
+        char symbol = detector.push(decimated[n]);
+        if (symbol != '\0') {
+            Decision decision = {static_cast<std::size_t>((n + 1) * static_cast<std::uint64_t>(sampleRate) / detectRate), symbol};
+            decisions.push_back(decision);
+        }
+    }
+    wallSeconds = secondsSince(start);
+    return decisions;
+}
+
+// Time from tone onset to decision for the block paths and the per-sample detector
+void benchLatency() {
+    const int sampleRate = 44100;
+    std::vector<ToneOnset> onsets;
+    std::vector<std::int16_t> samples = makeLatencySignal(sampleRate, 200, 0.1, 0.1, onsets);
+    double audioSeconds = static_cast<double>(samples.size()) / sampleRate;
+
+    reportLatency("FFT 2048, hop 1024 (DTMF4)", onsets, blockFFTDecisions(samples, sampleRate, 2048, 1024), sampleRate);
+    reportLatency("Goertzel 4096-sample callback blocks", onsets, blockGoertzelDecisions(samples, sampleRate, 4096, 4096), sampleRate);
+    reportLatency("Goertzel 1130, hop 565", onsets, blockGoertzelDecisions(samples, sampleRate, 1130, 565), sampleRate);
+
+    // Window and minimum duration in samples at 8 kHz
+    const int configs[][2] = {{205, 40}, {205, 80}, {205, 160}, {128, 40}};
+    for (const auto& config : configs) {
+        double wallSeconds = 0.0;
+        std::vector<Decision> decisions = slidingDecisions(samples, sampleRate, config[0], config[1], wallSeconds);
+        std::string name = "sliding DFT " + std::to_string(config[0]) + " @ 8 kHz, hold " +
+                           std::to_string(config[1] / 8) + " ms";
+        reportLatency(name.c_str(), onsets, decisions, sampleRate);
+        std::cout << "  " << decisions.size() << " symbol events, " << audioSeconds / wallSeconds
+                  << "x real time (incl. decimation)\n";
+    }
+}
+
+// Frames for comparing detector decisions: every symbol across noise, twist and
+// frequency offset, plus talk-off style signals (harmonics, single tones, noise)
+std::vector<std::int16_t> makeDecisionCorpus(int sampleRate, int frameSize, std::size_t& frameCount) {
+    std::vector<std::int16_t> corpus;
+    std::mt19937 rng(12);
+    std::normal_distribution<double> gaussian(0.0, 1.0);
+    std::uniform_real_distribution<double> uniform(0.0, 2 * PI);
+    const double noiseLevels[] = {0.0, 100.0, 1000.0, 3000.0, 6000.0};
+    const double twistsDb[] = {-6.0, -3.0, 0.0, 4.0, 8.0, 10.0};
+    const double offsets[] = {-0.03, -0.015, 0.0, 0.015, 0.03};
+    const double harmonics[] = {0.0, 0.3, 0.6};
+
+    auto addFrame = [&](double f1, double a1, double f2, double a2, double harmonic, double noise) {
+        double p1 = uniform(rng), p2 = uniform(rng);
+        for (int n = 0; n < frameSize; ++n) {
+            double t = static_cast<double>(n) / sampleRate;
+            double x = a1 * (sin(2 * PI * f1 * t + p1) + harmonic * sin(4 * PI * f1 * t + p1)) +
+                       a2 * (sin(2 * PI * f2 * t + p2) + harmonic * sin(4 * PI * f2 * t + p2)) +
+                       noise * gaussian(rng);
+            x = x > 32767.0 ? 32767.0 : (x < -32768.0 ? -32768.0 : x);
+            corpus.push_back(static_cast<std::int16_t>(x));
+        }
+    };
+
+    for (int row = 0; row < 4; ++row) {
+        for (int col = 0; col < 4; ++col) {
+            for (double noise : noiseLevels) {
+                for (double twist : twistsDb) {
+                    for (double offset : offsets) {
+                        for (double harmonic : harmonics) {
+                            double colAmplitude = 6000.0 * std::pow(10.0, twist / 20.0);
+                            addFrame(DTMF_ROW_FREQS[row] * (1 + offset), 6000.0,
+                                     DTMF_COL_FREQS[col] * (1 + offset), colAmplitude, harmonic, noise);
+                        }
+                    }
+                }
+            }
+        }
+    }
+    for (int i = 0; i < 2000; ++i) {
+        double f1 = 300.0 + 3000.0 * (rng() % 10000) / 10000.0;
+        double f2 = 300.0 + 3000.0 * (rng() % 10000) / 10000.0;
+        addFrame(f1, 8000.0, f2, (i % 2) * 8000.0, (i % 3) * 0.3, (i % 5) * 500.0);
+    }
+
+    frameCount = corpus.size() / frameSize;
+    return corpus;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+inline std::uint64_t cycleCounter() {
+    return __rdtsc();
+}
+#else
+inline std::uint64_t cycleCounter() {
+    return 0;
+}
+#endif
+
+// Floating-point and fixed-point detectors on the same corpus: decisions must match
+template <int SampleRate, int FrameSize>
+void benchFixedPoint() {
+    std::size_t frameCount = 0;
+    std::vector<std::int16_t> corpus = makeDecisionCorpus(SampleRate, FrameSize, frameCount);
+    GoertzelKernel<SampleRate, FrameSize> floating;
+    GoertzelFixed<SampleRate, FrameSize> fixed;
+    std::vector<char> floatDecisions(frameCount), fixedDecisions(frameCount);
+    const int rounds = 4;
+
+    std::uint64_t cycles = cycleCounter();
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r) {
+        for (std::size_t f = 0; f < frameCount; ++f) floatDecisions[f] = floating.detect(&corpus[f * FrameSize]);
+    }
+    double floatSeconds = secondsSince(start);
+    std::uint64_t floatCycles = cycleCounter() - cycles;
+
+    cycles = cycleCounter();
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r) {
+        for (std::size_t f = 0; f < frameCount; ++f) fixedDecisions[f] = fixed.detect(&corpus[f * FrameSize]);
+    }
+    double fixedSeconds = secondsSince(start);
+    std::uint64_t fixedCycles = cycleCounter() - cycles;
+
+    std::size_t detected = 0, mismatches = 0;
+    for (std::size_t f = 0; f < frameCount; ++f) {
+        if (floatDecisions[f] != '\0') ++detected;
+        if (floatDecisions[f] != fixedDecisions[f]) ++mismatches;
+    }
+
+    double frames = static_cast<double>(rounds) * frameCount;
+    std::cout << SampleRate << " Hz, " << FrameSize << "-sample frames: " << frameCount << " frames, "
+              << detected << " detected, " << mismatches << " decisions differ\n";
+    std::cout << "  double: " << floatSeconds / frames * 1e9 << " ns/frame";
+    if (floatCycles) std::cout << ", " << floatCycles / frames << " cycles/frame";
+    std::cout << "\n  fixed:  " << fixedSeconds / frames * 1e9 << " ns/frame";
+    if (fixedCycles) std::cout << ", " << fixedCycles / frames << " cycles/frame";
+    std::cout << "\n";
+}
+
+// DTMF4's whole-bin path against the small-frame detector (windowed, interpolated)
+struct FFTPathConfig {
+    const char* name;
+    int detectRate; // Frames are taken at this rate, decimated from the capture rate if lower
+    int frameSize;
+    FFTWindow window;
+    bool wholeBins; // DTMF4: power spectrum, two strongest bins, frequency table
+};
+
+// Decides frames for one configuration
+class FFTPath {
+public:
+    explicit FFTPath(const FFTPathConfig& config)
+        : config(config), fft(config.frameSize, "", FFTW_ESTIMATE),
+          small(config.detectRate, config.frameSize, config.window, "", FFTW_ESTIMATE) {}
+
+    char detect(const std::int16_t* frame) {
+        if (!config.wholeBins) return small.detect(frame);
+        std::pair<int, int> peaks = findStrongestFrequencies(fft.power(frame, config.frameSize), config.detectRate);
+        return dtmfSymbolAt(peaks.first, peaks.second);
+    }
+
+private:
+    FFTPathConfig config;
+    FFTWorkspace fft;
+    FFTToneDetector small;
+};
+
+// One frame of two tones with random phases in white noise
+void addToneFrame(std::vector<std::int16_t>& frames, int sampleRate, int frameSize, double f1, double a1, double f2,
+                  double a2, double noise, std::mt19937& rng) {
+    std::normal_distribution<double> gaussian(0.0, 1.0);
+    double p1 = (rng() % 1000) * 2 * PI / 1000, p2 = (rng() % 1000) * 2 * PI / 1000;
+    for (int n = 0; n < frameSize; ++n) {
+        double t = static_cast<double>(n) / sampleRate;
+        double x = a1 * sin(2 * PI * f1 * t + p1) + a2 * sin(2 * PI * f2 * t + p2) + noise * gaussian(rng);
+        frames.push_back(static_cast<std::int16_t>(std::max(-32768.0, std::min(32767.0, x))));
+    }
+}
+
+void benchSmallFrameFFT() {
+    const int captureRate = 44100;
+    const FFTPathConfig configs[] = {
+        {"DTMF4 2048 @ 44.1 kHz, whole bins", captureRate, 2048, WINDOW_RECTANGULAR, true},
+        {"512 @ 44.1 kHz, Hann", captureRate, 512, WINDOW_HANN, false},
+        {"512 @ 44.1 kHz, Blackman-Harris", captureRate, 512, WINDOW_BLACKMAN_HARRIS, false},
+        {"256 @ 8 kHz, Hann", 8000, 256, WINDOW_HANN, false},
+        {"256 @ 8 kHz, Blackman-Harris", 8000, 256, WINDOW_BLACKMAN_HARRIS, false},
+        {"512 @ 8 kHz, Hann", 8000, 512, WINDOW_HANN, false},
+    };
+    const double noiseLevels[] = {0.0, 600.0, 1900.0}; // Clean, ~20 dB and ~10 dB SNR over the 4 kHz band
+    const double offsets[] = {-0.01, 0.0, 0.01};
+    const double twistsDb[] = {-3.0, 0.0, 6.0};
+
+    std::vector<ToneOnset> onsets;
+    std::vector<std::int16_t> latencySignal = makeLatencySignal(captureRate, 200, 0.1, 0.1, onsets);
+
+    for (const FFTPathConfig& config : configs) {
+        FFTPath path(config);
+        int n = config.frameSize;
+
+        // Valid symbols across noise, offset and twist; talk-off frames that must not decode.
+        // Noise is white over the whole band, so it is scaled to put the same power below 4 kHz.
+        double noiseScale = std::sqrt(config.detectRate / 8000.0);
+        std::mt19937 rng(5);
+        std::vector<std::int16_t> tones, talkOff;
+        std::vector<char> expected;
+        for (int row = 0; row < 4; ++row) {
+            for (int col = 0; col < 4; ++col) {
+                for (double noise : noiseLevels) {
+                    for (double offset : offsets) {
+                        for (double twist : twistsDb) {
+                            addToneFrame(tones, config.detectRate, n, DTMF_ROW_FREQS[row] * (1 + offset), 4000.0,
+                                         DTMF_COL_FREQS[col] * (1 + offset), 4000.0 * std::pow(10.0, twist / 20.0), noise * noiseScale,
+                                         rng);
+                            expected.push_back(DTMF_SYMBOLS[row][col]);
+                        }
+                    }
+                }
+            }
+        }
+        for (int i = 0; i < 1500; ++i) {
+            double f1 = 300.0 + 3000.0 * (rng() % 10000) / 10000.0;
+            double f2 = 300.0 + 3000.0 * (rng() % 10000) / 10000.0;
+            bool nearTone = false; // Pairs this close to DTMF are allowed to decode
+            for (int tone = 0; tone < 8; ++tone) {
+                double f = dtmfToneFrequency(tone);
+                if (std::fabs(f1 - f) < 0.04 * f || std::fabs(f2 - f) < 0.04 * f) nearTone = true;
+            }
+            if (nearTone) continue;
+            addToneFrame(talkOff, config.detectRate, n, f1, 4000.0, f2, (i % 2) * 4000.0, (i % 3) * 1000.0 * noiseScale, rng);
+        }
+
+        std::size_t toneFrames = tones.size() / n, talkOffFrames = talkOff.size() / n;
+        std::size_t correct = 0, wrong = 0, falseDetections = 0;
+        const int rounds = 4;
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < rounds; ++r) {
+            for (std::size_t f = 0; f < toneFrames; ++f) {
+                char symbol = path.detect(&tones[f * n]);
+                if (r > 0) continue;
+                if (symbol == expected[f]) ++correct;
+                else if (symbol != '\0') ++wrong;
+            }
+        }
+        double nsPerFrame = secondsSince(start) * 1e9 / (rounds * toneFrames);
+        for (std::size_t f = 0; f < talkOffFrames; ++f) {
+            if (path.detect(&talkOff[f * n]) != '\0') ++falseDetections;
+        }
+
+        // Time-to-detect on the shared latency signal, hop of half a frame
+        std::vector<std::int16_t> frames = latencySignal;
+        if (config.detectRate < captureRate) {
+            Decimator decimator(captureRate, config.detectRate);
+            frames.resize(decimator.outputCapacity(latencySignal.size()));
+            frames.resize(decimator.process(latencySignal.data(), latencySignal.size(), frames.data()));
+        }
+        std::vector<Decision> decisions;
+        for (std::size_t f = 0; f + n <= frames.size(); f += n / 2) {
+            char symbol = path.detect(&frames[f]);
+            if (symbol == '\0') continue;
+            Decision decision = {static_cast<std::size_t>((f + n) * static_cast<std::uint64_t>(captureRate) / config.detectRate), symbol};
+            decisions.push_back(decision);
+        }
+
+        std::cout << config.name << ": " << 1000.0 * n / config.detectRate << " ms frames, " << nsPerFrame
+                  << " ns/frame, " << nsPerFrame * 1e-3 * config.detectRate / (n / 2) << " us per second of audio at hop "
+                  << n / 2 << "\n  " << correct << "/" << toneFrames << " symbols correct, " << wrong << " wrong, "
+                  << falseDetections << "/" << talkOffFrames << " talk-off frames decoded\n  ";
+        reportLatency("latency", onsets, decisions, captureRate);
+    }
+}
+
+// Micro-benchmark suite.
+// Every kernel is timed per frame on a synthetic signal, first on one core and then
+// with one independent instance per core, and the results can be written as JSON.
+
+// Processes one frame of the benchmark signal; each thread gets its own instance
+typedef std::function<void(const std::int16_t* frame)> FrameWork;
+
+// Keeps a result alive so the compiler cannot drop the work that produced it
+template <typename T>
+inline void keep(const T& value) {
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+struct MicroResult {
+    std::string name;
+    int sampleRate;
+    int frameSize;
+    double snrDb;
+    unsigned threads;
+    std::size_t frames;      // Frames processed across all threads
+    double samplesPerSecond; // Aggregate over all threads
+    double nsPerFrame;       // Core time per frame
+    double p50NsPerFrame;    // Over batches of BATCH_FRAMES frames
+    double p99NsPerFrame;
+};
+
+struct MicroConfig {
+    std::vector<int> sampleRates;
+    std::vector<int> frameSizes; // Empty: 25 ms frames and DTMF4's 2048
+    std::vector<double> snrs;
+    unsigned threads;            // "All cores" run
+    double minSeconds;           // Per measurement
+};
+
+const int BATCH_FRAMES = 16;
+const double SIGNAL_SECONDS = 1.0; // Benchmark signal length, processed cyclically
+
+// Symbols changing every 100 ms in white noise at the given SNR
+std::vector<std::int16_t> makeNoisySignal(int sampleRate, double snrDb) {
+    std::size_t count = static_cast<std::size_t>(SIGNAL_SECONDS * sampleRate);
+    std::vector<std::int16_t> samples(count);
+    std::mt19937 rng(3);
+    std::normal_distribution<double> gaussian(0.0, 1.0);
+    double signalPower = AMPLITUDE * AMPLITUDE / 4.0; // Two tones of amplitude AMPLITUDE / 2
+    double noise = std::sqrt(signalPower / std::pow(10.0, snrDb / 10.0));
+    std::size_t toneLength = sampleRate / 10;
+
+    for (std::size_t i = 0; i < count; ++i) {
+        int symbol = static_cast<int>(i / toneLength) % 16;
+        double t = static_cast<double>(i) / sampleRate;
+        double x = AMPLITUDE * 0.5 * (sin(2 * PI * DTMF_ROW_FREQS[symbol / 4] * t) +
+                                      sin(2 * PI * DTMF_COL_FREQS[symbol % 4] * t)) + noise * gaussian(rng);
+        samples[i] = static_cast<std::int16_t>(std::max(-32768.0, std::min(32767.0, x)));
+    }
+    return samples;
+}
+
+// Run one kernel on `threads` threads for at least minSeconds
+MicroResult measure(const std::string& name, const std::vector<std::int16_t>& signal, int sampleRate, int frameSize,
+                    double snrDb, unsigned threads, double minSeconds, const std::function<FrameWork()>& makeWork) {
+    // Instances are built serially: FFTW planning is not thread-safe
+    std::vector<FrameWork> work;
+    for (unsigned t = 0; t < threads; ++t) work.push_back(makeWork());
+
+    std::size_t frameCount = signal.size() / frameSize;
+    std::vector<std::vector<double> > batchNs(threads);
+    std::vector<std::size_t> frames(threads, 0);
+    std::atomic<unsigned> ready(0);
+    std::atomic<bool> go(false);
+
+    auto body = [&](unsigned t) {
+        ++ready;
+        while (!go) std::this_thread::yield();
+        auto start = std::chrono::steady_clock::now();
+        std::size_t f = t * frameCount / threads; // Threads start at different places in the signal
+        while (secondsSince(start) < minSeconds) {
+            auto batchStart = std::chrono::steady_clock::now();
+            for (int b = 0; b < BATCH_FRAMES; ++b) {
+                work[t](&signal[f * frameSize]);
+                if (++f == frameCount) f = 0;
+            }
+            batchNs[t].push_back(secondsSince(batchStart) * 1e9 / BATCH_FRAMES);
+            frames[t] += BATCH_FRAMES;
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threads; ++t) pool.push_back(std::thread(body, t));
+    while (ready < threads - 1) std::this_thread::yield();
+    auto start = std::chrono::steady_clock::now();
+    go = true;
+    body(0);
+    for (auto& thread : pool) thread.join();
+    double wall = secondsSince(start);
+
+    MicroResult result;
+    result.name = name;
+    result.sampleRate = sampleRate;
+    result.frameSize = frameSize;
+    result.snrDb = snrDb;
+    result.threads = threads;
+    result.frames = 0;
+    std::vector<double> all;
+    for (unsigned t = 0; t < threads; ++t) {
+        result.frames += frames[t];
+        all.insert(all.end(), batchNs[t].begin(), batchNs[t].end());
+    }
+    std::sort(all.begin(), all.end());
+    result.samplesPerSecond = static_cast<double>(result.frames) * frameSize / wall;
+    result.nsPerFrame = wall * threads * 1e9 / result.frames;
+    result.p50NsPerFrame = all[all.size() / 2];
+    result.p99NsPerFrame = all[all.size() * 99 / 100];
+    return result;
+}
+
+// Kernels that are specialised for one sample rate and frame size
+template <int SampleRate, int FrameSize>
+void addSpecialisedKernels(int sampleRate, int frameSize, std::vector<std::pair<std::string, std::function<FrameWork()> > >& kernels) {
+    if (sampleRate != SampleRate || frameSize != FrameSize) return;
+
+    kernels.push_back(std::make_pair(std::string("GoertzelKernel"), std::function<FrameWork()>([]() {
+        auto kernel = std::make_shared<GoertzelKernel<SampleRate, FrameSize> >();
+        return FrameWork([kernel](const std::int16_t* frame) { keep(kernel->detect(frame)); });
+    })));
+    kernels.push_back(std::make_pair(std::string("GoertzelFixed"), std::function<FrameWork()>([]() {
+        auto kernel = std::make_shared<GoertzelFixed<SampleRate, FrameSize> >();
+        return FrameWork([kernel](const std::int16_t* frame) { keep(kernel->detect(frame)); });
+    })));
+}
+
+// One line per result goes to log: stdout normally, stderr when the JSON report takes stdout
+std::vector<MicroResult> runMicroSuite(const MicroConfig& config, std::ostream& log) {
+    std::vector<MicroResult> results;
+
+    for (int sampleRate : config.sampleRates) {
+        std::vector<int> frameSizes = config.frameSizes;
+        // 205 at 8 kHz, 1130 at 44.1 kHz; never 0, however low the rate
+        if (frameSizes.empty()) frameSizes = {std::max(1, 205 * sampleRate / 8000), 2048};
+
+        for (double snrDb : config.snrs) {
+            std::vector<std::int16_t> signal = makeNoisySignal(sampleRate, snrDb);
+
+            for (int frameSize : frameSizes) {
+                if (static_cast<std::size_t>(frameSize) > signal.size()) continue;
+                std::vector<std::pair<std::string, std::function<FrameWork()> > > kernels;
+
+                // Tone generation, frameSize samples per call
+                kernels.push_back(std::make_pair(std::string("generateDTMFTone"), std::function<FrameWork()>([=]() {
+                    auto samples = std::make_shared<std::vector<std::int16_t> >();
+                    return FrameWork([=](const std::int16_t*) {
+                        generateDTMFToneLegacy(697, 1209, sampleRate, *samples, static_cast<double>(frameSize) / sampleRate);
+                        keep(samples->back());
+                    });
+                })));
+                kernels.push_back(std::make_pair(std::string("DTMFSynth::render"), std::function<FrameWork()>([=]() {
+                    auto synth = std::make_shared<DTMFSynth>(sampleRate, AMPLITUDE);
+                    auto samples = std::make_shared<std::vector<std::int16_t> >(frameSize);
+                    auto phase = std::make_shared<std::size_t>(0);
+                    return FrameWork([=](const std::int16_t*) {
+                        synth->render(0, 0, samples->data(), frameSize, *phase);
+                        keep(samples->back());
+                    });
+                })));
+
+                // DTMF4's chain, stage by stage
+                kernels.push_back(std::make_pair(std::string("performFFT"), std::function<FrameWork()>([=]() {
+                    auto fft = std::make_shared<FFTWorkspace>(frameSize);
+                    return FrameWork([=](const std::int16_t* frame) { keep(fft->transform(frame, frameSize).back()); });
+                })));
+                kernels.push_back(std::make_pair(std::string("findStrongestFrequencies"), std::function<FrameWork()>([=, &signal]() {
+                    FFTWorkspace fft(frameSize, "", FFTW_ESTIMATE);
+                    auto magnitudes = std::make_shared<std::vector<double> >(fft.transform(signal.data(), frameSize));
+                    return FrameWork([=](const std::int16_t*) { keep(findStrongestFrequencies(*magnitudes, sampleRate)); });
+                })));
+                kernels.push_back(std::make_pair(std::string("powerSpectrum"), std::function<FrameWork()>([=]() {
+                    auto fft = std::make_shared<FFTWorkspace>(frameSize);
+                    return FrameWork([=](const std::int16_t* frame) { keep(fft->power(frame, frameSize).back()); });
+                })));
+                kernels.push_back(std::make_pair(std::string("frameEnergy"), std::function<FrameWork()>([=]() {
+                    return FrameWork([=](const std::int16_t* frame) { keep(spectrumKernels().energy(frame, frameSize)); });
+                })));
+                kernels.push_back(std::make_pair(std::string("detectDTMF"), std::function<FrameWork()>([]() {
+                    auto next = std::make_shared<int>(0);
+                    return FrameWork([=](const std::int16_t*) {
+                        int symbol = (*next)++ & 15;
+                        keep(dtmfSymbolAt(DTMF_COL_FREQS[symbol % 4], DTMF_ROW_FREQS[symbol / 4]));
+                    });
+                })));
+
+                // Detection engines
+                kernels.push_back(std::make_pair(std::string("GoertzelDetector"), std::function<FrameWork()>([=]() {
+                    auto detector = std::make_shared<GoertzelDetector>(sampleRate);
+                    return FrameWork([=](const std::int16_t* frame) { keep(detector->detect(frame, frameSize)); });
+                })));
+                addSpecialisedKernels<8000, 205>(sampleRate, frameSize, kernels);
+                addSpecialisedKernels<16000, 410>(sampleRate, frameSize, kernels);
+                addSpecialisedKernels<44100, 1130>(sampleRate, frameSize, kernels);
+                addSpecialisedKernels<48000, 1230>(sampleRate, frameSize, kernels);
+                kernels.push_back(std::make_pair(std::string("SlidingDFTDetector"), std::function<FrameWork()>([=]() {
+                    auto detector = std::make_shared<SlidingDFTDetector>(sampleRate, frameSize, frameSize / 5);
+                    return FrameWork([=](const std::int16_t* frame) {
+                        for (int n = 0; n < frameSize; ++n) keep(detector->push(frame[n]));
+                    });
+                })));
+                if (sampleRate > 8000) {
+                    kernels.push_back(std::make_pair(std::string("Decimator"), std::function<FrameWork()>([=]() {
+                        auto decimator = std::make_shared<Decimator>(sampleRate, 8000);
+                        auto out = std::make_shared<std::vector<std::int16_t> >(decimator->outputCapacity(frameSize));
+                        return FrameWork([=](const std::int16_t* frame) { keep(decimator->process(frame, frameSize, out->data())); });
+                    })));
+                }
+
+                for (const auto& kernel : kernels) {
+                    // Single core, then one instance per core
+                    std::vector<unsigned> threadCounts(1, 1);
+                    if (config.threads > 1) threadCounts.push_back(config.threads);
+                    for (unsigned threads : threadCounts) {
+                        MicroResult result = measure(kernel.first, signal, sampleRate, frameSize, snrDb, threads,
+                                                     config.minSeconds, kernel.second);
+                        log << result.name << " @ " << sampleRate << " Hz, " << frameSize << " samples, "
+                            << snrDb << " dB SNR, " << threads << " thread(s): " << result.nsPerFrame
+                            << " ns/frame (p99 " << result.p99NsPerFrame << "), "
+                            << result.samplesPerSecond / 1e6 << " Msamples/s\n";
+                        results.push_back(result);
+                    }
+                }
+            }
+        }
+    }
+    return results;
+}
+
+std::string toJson(const MicroConfig& config, const std::vector<MicroResult>& results) {
+    std::ostringstream json;
+    json.precision(10);
+    json << "{\n  \"config\": {\"threads\": " << config.threads << ", \"minSeconds\": " << config.minSeconds
+         << ", \"hardwareConcurrency\": " << std::thread::hardware_concurrency() << "},\n  \"results\": [\n";
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const MicroResult& r = results[i];
+        json << "    {\"name\": \"" << r.name << "\", \"sampleRate\": " << r.sampleRate
+             << ", \"frameSize\": " << r.frameSize << ", \"snrDb\": " << r.snrDb << ", \"threads\": " << r.threads
+             << ", \"frames\": " << r.frames << ", \"samplesPerSecond\": " << r.samplesPerSecond
+             << ", \"nsPerFrame\": " << r.nsPerFrame << ", \"p50NsPerFrame\": " << r.p50NsPerFrame
+             << ", \"p99NsPerFrame\": " << r.p99NsPerFrame << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    json << "  ]\n}\n";
+    return json.str();
+}
+
+// Comma-separated list of numbers
+template <typename T>
+std::vector<T> parseList(const char* text) {
+    std::vector<T> values;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) values.push_back(static_cast<T>(std::atof(item.c_str())));
+    }
+    return values;
+}
+
+// ns per call of work(), best of a few runs
+template <typename Work>
+double nsPerCall(int calls, Work work) {
+    double best = 0.0;
+    for (int run = 0; run < 5; ++run) {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < calls; ++i) work();
+        double ns = secondsSince(start) * 1e9 / calls;
+        if (run == 0 || ns < best) best = ns;
+    }
+    return best;
+}
+
+// Loudness gate, power spectrum and peak search: the scalar reference against every
+// SIMD build this CPU runs, on DTMF4's 2048-sample frames. Each build's results are
+// checked against the scalar ones.
+void benchSpectrumKernels() {
+    const int sampleRate = 44100, frameSize = 2048, bins = frameSize / 2, calls = 20000;
+    const int firstBin = (DTMF_ROW_FREQS[0] - DTMF_TOLERANCE_HZ) * frameSize / sampleRate;
+    const int lastBin = ((DTMF_COL_FREQS[3] + DTMF_TOLERANCE_HZ) * frameSize + sampleRate - 1) / sampleRate;
+
+    // A loud frame: full-scale samples make the pairwise sums of squares reach 2^31
+    std::vector<std::int16_t> frame = makeNoisySignal(sampleRate, 20.0);
+    frame.resize(frameSize);
+    for (int i = 0; i < frameSize; i += 7) frame[i] = -32768;
+
+    FFTWorkspace fft(frameSize, "", FFTW_ESTIMATE);
+    fft.execute(frame.data(), frameSize);
+    const double* spectrum = fft.spectrum()[0];
+    std::vector<double> magnitudes = fft.transform(frame.data(), frameSize);
+
+    SpectrumKernels scalar = spectrumKernelsFor(KERNEL_SCALAR);
+    std::vector<double> referencePower(bins), power(bins);
+    scalar.power(spectrum, bins, referencePower.data());
+    std::int64_t referenceEnergy = scalar.energy(frame.data(), frameSize);
+    int referenceAll[2], referenceBand[2];
+    scalar.peaks(referencePower.data(), 0, bins - 1, referenceAll);
+    scalar.peaks(referencePower.data(), firstBin, lastBin, referenceBand);
+
+    // What the kernels replace: DTMF4's sqrt loop and whole-spectrum search
+    double sqrtNs = nsPerCall(calls, [&]() {
+        for (int i = 0; i < bins; ++i) power[i] = sqrt(spectrum[2 * i] * spectrum[2 * i] + spectrum[2 * i + 1] * spectrum[2 * i + 1]);
+        keep(power.back());
+    });
+    double legacyPeakNs = nsPerCall(calls, [&]() { keep(findStrongestFrequencies(magnitudes, sampleRate)); });
+    std::cout << "legacy: magnitude loop " << sqrtNs << " ns, findStrongestFrequencies " << legacyPeakNs << " ns\n";
+
+    double scalarNs[4] = {0, 0, 0, 0};
+    const KernelType types[] = {KERNEL_SCALAR, KERNEL_SSE2, KERNEL_AVX2, KERNEL_NEON};
+    for (KernelType type : types) {
+        if (!kernelSupported(type)) continue;
+        SpectrumKernels kernels = spectrumKernelsFor(type);
+
+        std::int64_t energy = 0;
+        int all[2], band[2];
+        double ns[4];
+        ns[0] = nsPerCall(calls, [&]() { energy = kernels.energy(frame.data(), frameSize); keep(energy); });
+        ns[1] = nsPerCall(calls, [&]() { kernels.power(spectrum, bins, power.data()); keep(power.back()); });
+        ns[2] = nsPerCall(calls, [&]() { kernels.peaks(power.data(), 0, bins - 1, all); keep(all[1]); });
+        ns[3] = nsPerCall(calls, [&]() { kernels.peaks(power.data(), firstBin, lastBin, band); keep(band[1]); });
+        if (type == KERNEL_SCALAR) std::copy(ns, ns + 4, scalarNs);
+
+        // Power within rounding: with -march flags the scalar loop may be compiled to FMAs
+        bool same = energy == referenceEnergy && all[0] == referenceAll[0] &&
+                    all[1] == referenceAll[1] && band[0] == referenceBand[0] && band[1] == referenceBand[1];
+        for (int i = 0; i < bins; ++i) same = same && std::fabs(power[i] - referencePower[i]) <= 1e-15 * referencePower[i];
+        std::cout << kernelTypeName(type) << ": energy " << ns[0] << " ns (x" << scalarNs[0] / ns[0] << "), power "
+                  << ns[1] << " ns (x" << scalarNs[1] / ns[1] << "), top two of " << bins << " bins " << ns[2]
+                  << " ns (x" << scalarNs[2] / ns[2] << "), of the " << lastBin - firstBin + 1 << " DTMF bins "
+                  << ns[3] << " ns (x" << scalarNs[3] / ns[3] << "), " << (same ? "matches" : "DIFFERS FROM")
+                  << " scalar\n";
+    }
+}
+
+// The comparison reports from earlier optimisation work (human-readable only)
+void runReports(int channels, int sampleRate) {
+    int blockSize = std::max(1, sampleRate / 40); // 25 ms blocks
+
+    std::size_t frames = static_cast<std::size_t>(SECONDS * sampleRate);
+    std::vector<std::int16_t> interleaved = makeInterleavedSignal(channels, sampleRate, frames);
+
+    std::cout << channels << " channels, " << sampleRate << " Hz, " << blockSize << "-sample blocks, "
+              << SECONDS << " s of audio per channel\n";
+
+    benchIndependent(interleaved, channels, sampleRate, blockSize, frames);
+    benchMultiChannel(interleaved, channels, sampleRate, blockSize, frames, KERNEL_SCALAR);
+    benchMultiChannel(interleaved, channels, sampleRate, blockSize, frames, KERNEL_AUTO);
+
+    std::cout << "\nTone synthesis, " << sampleRate << " Hz\n";
+    benchSynthesis(sampleRate);
+
+    std::cout << "\nDecimation front-end, " << SECONDS << " s of mono audio\n";
+    benchDecimation<GoertzelKernel44k>();
+    benchDecimation<GoertzelKernel48k>();
+
+    std::cout << "\nTime-to-detect, 44100 Hz capture, 200 tones of 100 ms\n";
+    benchLatency();
+
+    std::cout << "\nDTMF4's FFT path against small windowed frames with interpolated peaks\n";
+    benchSmallFrameFFT();
+
+    std::cout << "\nSpectrum kernels, 2048-sample frames at 44100 Hz\n";
+    benchSpectrumKernels();
+
+    std::cout << "\nFixed-point detector against double, shared decision corpus\n";
+    benchFixedPoint<8000, 205>();
+    benchFixedPoint<44100, 1130>();
+}
+
+int main(int argc, char* argv[]) {
+    MicroConfig config;
+    config.sampleRates = {8000, 44100};
+    config.snrs = {20.0};
+    int threads = static_cast<int>(std::thread::hardware_concurrency());
+    if (threads == 0) threads = 1;
+    config.minSeconds = 0.2;
+
+    const char* jsonPath = nullptr;
+    bool reports = false;
+    int channels = 256;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--rates") == 0 && i + 1 < argc) config.sampleRates = parseList<int>(argv[++i]);
+        else if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc) config.frameSizes = parseList<int>(argv[++i]);
+        else if (std::strcmp(argv[i], "--snr") == 0 && i + 1 < argc) config.snrs = parseList<double>(argv[++i]);
+        else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) threads = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--time") == 0 && i + 1 < argc) config.minSeconds = std::atof(argv[++i]);
+        else if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc) jsonPath = argv[++i];
+        else if (std::strcmp(argv[i], "--reports") == 0) reports = true;
+        else if (std::strcmp(argv[i], "--channels") == 0 && i + 1 < argc) channels = std::atoi(argv[++i]);
+        else {
+            std::cerr << "Usage: bench [--rates HZ,...] [--frames N,...] [--snr DB,...] [--threads T] [--time S]\n"
+                         "             [--json FILE|-] [--reports [--channels C]]\n";
+            return -1;
+        }
+    }
+
+    for (int rate : config.sampleRates) {
+        if (rate <= 0) {
+            std::cerr << "Sample rates must be positive\n";
+            return -1;
+        }
+    }
+    for (int frameSize : config.frameSizes) {
+        if (frameSize <= 0) {
+            std::cerr << "Frame sizes must be positive\n";
+            return -1;
+        }
+    }
+    if (threads < 1 || threads > 1024) {
+        std::cerr << "Threads must be 1-1024\n";
+        return -1;
+    }
+    config.threads = threads;
+    if (config.minSeconds <= 0.0 || config.snrs.empty() || config.sampleRates.empty()) {
+        std::cerr << "Invalid benchmark configuration\n";
+        return -1;
+    }
+
+    if (reports) {
+        runReports(channels, config.sampleRates[0]);
+        return 0;
+    }
+
+    bool jsonToStdout = jsonPath && std::strcmp(jsonPath, "-") == 0;
+    std::vector<MicroResult> results = runMicroSuite(config, jsonToStdout ? std::cerr : std::cout);
+    if (jsonPath) {
+        std::string json = toJson(config, results);
+        if (jsonToStdout) {
+            std::cout << json;
+        } else {
+            std::ofstream file(jsonPath);
+            file << json;
+            if (!file) {
+                std::cerr << "Cannot write " << jsonPath << "\n";
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+// g++ bench.cpp -o bench -O2 -pthread -std=c++17 -lfftw3
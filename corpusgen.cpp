@@ -0,0 +1,342 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <map>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <memory>
+#include <cmath>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <sys/stat.h>
+#include "dtmf.hpp"
+#include "synth.hpp"
+#include "audioio.hpp"
+
+const std::size_t CHUNK = 65536;      // Samples rendered and written at a time
+const int NOISE_TABLE_BITS = 16;      // Gaussian noise table of 2^16 entries
+const int DETECT_BANDWIDTH = 8000;    // SNR is measured over the 4 kHz band the receivers see
+
+// One file of the corpus
+struct CorpusItem {
+    std::string name;
+    std::string symbols;
+    int sampleRate = 44100;
+    double toneMs = 50.0;
+    double gapMs = 50.0;
+    double leadMs = 200.0;   // Silence (or noise) before the first tone
+    int amplitude = 20000;   // Peak of row + column tone
+    double snrDb = INFINITY; // Tone power over noise power; infinite means no noise
+    double offset = 0.0;     // Frequency error of both tones (%)
+    double twistDb = 0.0;    // Column over row level
+    unsigned seed = 1;
+};
+
+// A tone in the rendered file, in samples
+struct Label {
+    std::size_t start;
+    std::size_t end;
+    char symbol;
+};
+
+// Unit Gaussian values, shared read-only by every thread. Noise is read from it at
+// random positions, which is far cheaper than std::normal_distribution per sample.
+const std::vector<float>& noiseTable() {
+    static const std::vector<float> table = []() {
+        std::vector<float> values(1u << NOISE_TABLE_BITS);
+        std::mt19937 rng(12345);
+        std::normal_distribution<float> gaussian(0.0f, 1.0f);
+        for (float& v : values) v = gaussian(rng);
+        return values;
+    }();
+    return table;
+}
+
+// Renders one item chunk by chunk, so memory use does not depend on its length
+class ItemRenderer {
+public:
+    ItemRenderer(const CorpusItem& item, const DTMFSynth* synth)
+        : item(item), synth(synth), position(0), state(item.seed * 2654435761u | 1) {
+        std::size_t tone = static_cast<std::size_t>(item.toneMs * item.sampleRate / 1000);
+        std::size_t gap = static_cast<std::size_t>(item.gapMs * item.sampleRate / 1000);
+        std::size_t cursor = static_cast<std::size_t>(item.leadMs * item.sampleRate / 1000);
+        for (char symbol : item.symbols) {
+            labels.push_back({cursor, cursor + tone, symbol});
+            cursor += tone + gap;
+        }
+        total = cursor;
+        current = 0;
+
+        double columnShare = std::pow(10.0, item.twistDb / 20.0);
+        rowAmplitude = item.amplitude / (1.0 + columnShare);
+        columnAmplitude = item.amplitude - rowAmplitude;
+        // Against the nominal tone pair, as in harness.cpp
+        double signalPower = item.amplitude * item.amplitude / 4.0;
+        noiseRms = std::isinf(item.snrDb) ? 0.0
+            : std::sqrt(signalPower / std::pow(10.0, item.snrDb / 10.0) * item.sampleRate / DETECT_BANDWIDTH);
+    }
+
+    const std::vector<Label>& getLabels() const {
+        return labels;
+    }
+
+    std::size_t getTotal() const {
+        return total;
+    }
+
+    // Render up to count samples; returns how many (0 at the end)
+    std::size_t next(std::int16_t* out, std::size_t count) {
+        if (count > total - position) count = total - position;
+        std::memset(out, 0, count * sizeof(std::int16_t));
+
+        std::size_t end = position + count;
+        while (current < labels.size() && labels[current].start < end) {
+            const Label& label = labels[current];
+            std::size_t from = std::max(label.start, position), to = std::min(label.end, end);
+            if (from < to) renderTone(label, from, out + (from - position), to - from);
+            if (label.end > end) break; // Continues in the next chunk
+            ++current;
+        }
+
+        if (noiseRms > 0.0) addNoise(out, count);
+        position = end;
+        return count;
+    }
+
+private:
+    void renderTone(const Label& label, std::size_t from, std::int16_t* out, std::size_t count) {
+        int row, col;
+        dtmfPosition(label.symbol, row, col);
+        if (synth) {
+            // Nominal tones: copy out of the looped tables
+            std::size_t phase = from - label.start;
+            synth->render(row, col, out, count, phase);
+            return;
+        }
+        if (from == label.start) {
+            double scale = 1.0 + item.offset / 100.0;
+            oscillator.reset(new TonePairOscillator(DTMF_ROW_FREQS[row] * scale, DTMF_COL_FREQS[col] * scale,
+                                                    rowAmplitude, columnAmplitude, item.sampleRate));
+        }
+        oscillator->render(out, count);
+    }
+
+    void addNoise(std::int16_t* out, std::size_t count) {
+        const std::vector<float>& table = noiseTable();
+        const std::uint32_t mask = (1u << NOISE_TABLE_BITS) - 1;
+        float level = static_cast<float>(noiseRms);
+        for (std::size_t i = 0; i < count; ++i) {
+            // xorshift32: two table entries per draw
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            std::uint32_t r = state;
+            float x = out[i] + level * 0.70710678f * (table[r & mask] + table[(r >> 16) & mask]);
+            out[i] = static_cast<std::int16_t>(x < -32768.0f ? -32768.0f : x > 32767.0f ? 32767.0f : x);
+        }
+    }
+
+    const CorpusItem& item;
+    const DTMFSynth* synth;
+    std::vector<Label> labels;
+    std::size_t total;
+    std::size_t position;
+    std::size_t current; // First label not yet fully rendered
+    double rowAmplitude, columnAmplitude;
+    double noiseRms;
+    std::uint32_t state; // Noise generator
+    std::unique_ptr<TonePairOscillator> oscillator;
+};
+
+// Parse "name symbols key=value ..." (see usage). Returns false on a malformed line.
+bool parseItem(const std::string& line, const CorpusItem& defaults, CorpusItem& item) {
+    std::istringstream in(line);
+    item = defaults;
+    if (!(in >> item.name >> item.symbols)) return false;
+    for (char symbol : item.symbols) {
+        int row, col;
+        if (!dtmfPosition(symbol, row, col)) return false;
+    }
+
+    std::string option;
+    while (in >> option) {
+        std::size_t eq = option.find('=');
+        if (eq == std::string::npos) return false;
+        std::string key = option.substr(0, eq);
+        double value = std::atof(option.c_str() + eq + 1);
+        if (key == "rate") item.sampleRate = static_cast<int>(value);
+        else if (key == "tone") item.toneMs = value;
+        else if (key == "gap") item.gapMs = value;
+        else if (key == "lead") item.leadMs = value;
+        else if (key == "amplitude") item.amplitude = static_cast<int>(value);
+        else if (key == "snr") item.snrDb = value;
+        else if (key == "offset") item.offset = value;
+        else if (key == "twist") item.twistDb = value;
+        else if (key == "seed") item.seed = static_cast<unsigned>(value);
+        else return false;
+    }
+    return item.sampleRate > 0 && item.toneMs > 0 && item.gapMs >= 0 && item.leadMs >= 0;
+}
+
+// Random items around the defaults; with vary, timing and channel conditions are
+// spread over the range a receiver has to accept
+std::vector<CorpusItem> randomItems(std::size_t count, std::size_t length, bool vary, const CorpusItem& defaults) {
+    std::vector<CorpusItem> items;
+    std::mt19937 rng(defaults.seed);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    for (std::size_t n = 0; n < count; ++n) {
+        CorpusItem item = defaults;
+        char name[32];
+        std::snprintf(name, sizeof(name), "item%06zu", n);
+        item.name = name;
+        item.seed = defaults.seed + static_cast<unsigned>(n);
+        for (std::size_t i = 0; i < length; ++i) item.symbols += DTMF_SYMBOLS[rng() % 4][rng() % 4];
+        if (vary) {
+            item.toneMs = 40 + 60 * unit(rng);
+            item.gapMs = 40 + 60 * unit(rng);
+            item.snrDb = 10 + 20 * unit(rng);
+            item.offset = -1.5 + 3 * unit(rng);
+            item.twistDb = -3 + 9 * unit(rng);
+        }
+        items.push_back(item);
+    }
+    return items;
+}
+
+// Render one item to DIR/name.wav with labels in DIR/name.txt. Returns bytes written.
+std::size_t renderItem(const CorpusItem& item, const std::string& directory, const DTMFSynth* synth,
+                       std::vector<std::int16_t>& buffer) {
+    ItemRenderer renderer(item, synth);
+    std::string base = directory + "/" + item.name;
+
+    WavFileSink wav(base + ".wav", item.sampleRate);
+    if (!wav.isOpen()) return 0;
+    std::size_t count, written = 44;
+    while ((count = renderer.next(buffer.data(), buffer.size())) > 0) {
+        if (!wav.write(buffer.data(), count)) return 0;
+        written += count * sizeof(std::int16_t);
+    }
+    wav.close();
+
+    // Ground truth in batchdecode's format: start and end (seconds), symbol
+    std::FILE* labels = std::fopen((base + ".txt").c_str(), "w");
+    if (!labels) return 0;
+    std::fprintf(labels, "# rate=%d tone=%g gap=%g lead=%g amplitude=%d snr=%g offset=%g twist=%g seed=%u\n",
+                 item.sampleRate, item.toneMs, item.gapMs, item.leadMs, item.amplitude, item.snrDb, item.offset,
+                 item.twistDb, item.seed);
+    for (const Label& label : renderer.getLabels()) {
+        std::fprintf(labels, "%.6f\t%.6f\t%c\n", static_cast<double>(label.start) / item.sampleRate,
+                     static_cast<double>(label.end) / item.sampleRate, label.symbol);
+    }
+    std::fclose(labels);
+    return written;
+}
+
+int main(int argc, char* argv[]) {
+    CorpusItem defaults;
+    std::string directory = ".";
+    const char* manifest = nullptr;
+    std::size_t randomCount = 0, randomLength = 16;
+    bool vary = false;
+    int threadCount = static_cast<int>(std::thread::hardware_concurrency());
+    if (threadCount == 0) threadCount = 1;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--out") == 0 && i + 1 < argc) directory = argv[++i];
+        else if (std::strcmp(argv[i], "--manifest") == 0 && i + 1 < argc) manifest = argv[++i];
+        else if (std::strcmp(argv[i], "--random") == 0 && i + 1 < argc) randomCount = std::strtoul(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--length") == 0 && i + 1 < argc) randomLength = std::strtoul(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--vary") == 0) vary = true;
+        else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) threadCount = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--rate") == 0 && i + 1 < argc) defaults.sampleRate = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--tone") == 0 && i + 1 < argc) defaults.toneMs = std::atof(argv[++i]);
+        else if (std::strcmp(argv[i], "--gap") == 0 && i + 1 < argc) defaults.gapMs = std::atof(argv[++i]);
+        else if (std::strcmp(argv[i], "--amplitude") == 0 && i + 1 < argc) defaults.amplitude = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--snr") == 0 && i + 1 < argc) defaults.snrDb = std::atof(argv[++i]);
+        else if (std::strcmp(argv[i], "--offset") == 0 && i + 1 < argc) defaults.offset = std::atof(argv[++i]);
+        else if (std::strcmp(argv[i], "--twist") == 0 && i + 1 < argc) defaults.twistDb = std::atof(argv[++i]);
+        else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) defaults.seed = std::strtoul(argv[++i], nullptr, 10);
+        else {
+            manifest = nullptr;
+            randomCount = 0;
+            break;
+        }
+    }
+    if ((manifest == nullptr) == (randomCount == 0)) {
+        std::cerr << "Usage: corpusgen [--out DIR] [--threads T] (--manifest FILE | --random N [--length L] [--vary])\n"
+                  << "                 [--rate HZ] [--tone MS] [--gap MS] [--amplitude A] [--snr DB] [--offset PCT]\n"
+                  << "                 [--twist DB] [--seed S]\n"
+                  << "Manifest lines: name symbols [rate=HZ] [tone=MS] [gap=MS] [lead=MS] [amplitude=A] [snr=DB]\n"
+                  << "                [offset=PCT] [twist=DB] [seed=S]   (# starts a comment)\n";
+        return -1;
+    }
+    if (threadCount < 1 || threadCount > 1024) {
+        std::cerr << "Threads must be 1-1024\n";
+        return -1;
+    }
+
+    std::vector<CorpusItem> items;
+    if (manifest) {
+        std::ifstream in(manifest);
+        if (!in) {
+            std::cerr << "Cannot read " << manifest << "\n";
+            return -1;
+        }
+        std::string line;
+        for (int lineNumber = 1; std::getline(in, line); ++lineNumber) {
+            if (line.empty() || line[0] == '#') continue;
+            CorpusItem item;
+            if (!parseItem(line, defaults, item)) {
+                std::cerr << manifest << ":" << lineNumber << ": bad item\n";
+                return -1;
+            }
+            items.push_back(item);
+        }
+    } else {
+        items = randomItems(randomCount, randomLength, vary, defaults);
+    }
+
+    mkdir(directory.c_str(), 0755); // Fine if it already exists
+    noiseTable(); // Built once, before the workers share it
+
+    std::atomic<std::size_t> nextItem(0), bytes(0), failures(0);
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threadCount; ++t) {
+        workers.push_back(std::thread([&]() {
+            // Tone tables per (rate, amplitude), built on first use by this worker
+            std::map<std::pair<int, int>, std::unique_ptr<DTMFSynth> > synths;
+            std::vector<std::int16_t> buffer(CHUNK);
+            std::size_t n;
+            while ((n = nextItem++) < items.size()) {
+                const CorpusItem& item = items[n];
+                const DTMFSynth* synth = nullptr;
+                if (item.offset == 0.0 && item.twistDb == 0.0) {
+                    std::unique_ptr<DTMFSynth>& cached = synths[std::make_pair(item.sampleRate, item.amplitude)];
+                    if (!cached) cached.reset(new DTMFSynth(item.sampleRate, item.amplitude));
+                    synth = cached.get();
+                }
+                std::size_t written = renderItem(item, directory, synth, buffer);
+                if (written == 0) {
+                    std::cerr << "Failed to write " << directory << "/" << item.name << "\n";
+                    ++failures;
+                }
+                bytes += written;
+            }
+        }));
+    }
+    for (auto& worker : workers) worker.join();
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cerr << items.size() - failures << " files, " << bytes / 1e6 << " MB in " << elapsed << " s ("
+              << bytes / 1e6 / elapsed << " MB/s, " << threadCount << " threads)\n";
+    return failures == 0 ? 0 : 1;
+}
+
+// g++ corpusgen.cpp -o corpusgen -O2 -pthread -std=c++17
\ No newline at end of file
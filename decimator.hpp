@@ -0,0 +1,210 @@
+#ifndef DECIMATOR_HPP
+#define DECIMATOR_HPP
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Polyphase rational resampler for bringing capture rates down to the detector rate
+// (44.1k -> 8k is 80/441, 48k -> 8k is 1/6). The anti-alias filter is a Kaiser
+// windowed sinc; only the taps of the one polyphase branch needed for each output
+// sample are evaluated, so the cost is tapsPerPhase MACs per output sample.
+class Decimator {
+public:
+    // The filter is flat up to ~0.25 * outRate and reaches 60 dB by ~0.59 * outRate, so
+    // anything aliased lands above the DTMF band and its second harmonics. At 8 kHz the
+    // highest second harmonics (~3.3 kHz) come through ~5 dB down.
+    Decimator(int inRate, int outRate)
+        : inRate(inRate), outRate(outRate), phase(0), position(0) {
+        long g = gcd(inRate, outRate);
+        up = static_cast<int>(outRate / g);
+        down = static_cast<int>(inRate / g);
+
+        const double attenuation = 60.0;
+        const double beta = 0.1102 * (attenuation - 8.7);
+        double passband = 0.25 * outRate;
+        double stopband = 0.59 * outRate;
+        double cutoff = 0.5 * (passband + stopband);
+        double transition = 2 * 3.14159265358979323846 * (stopband - passband) / inRate;
+
+        // Kaiser length estimate at the input rate, spread across the polyphase branches
+        tapsPerPhase = static_cast<int>(std::ceil((attenuation - 8.0) / (2.285 * transition))) + 1;
+        int length = tapsPerPhase * up;
+        double center = 0.5 * (length - 1);
+        double fc = cutoff / (static_cast<double>(inRate) * up); // Cycles per sample at the upsampled rate
+
+        std::vector<double> prototype(length);
+        for (int i = 0; i < length; ++i) {
+            double t = i - center;
+            double sinc = t == 0.0 ? 2 * fc : std::sin(2 * 3.14159265358979323846 * fc * t) / (3.14159265358979323846 * t);
+            double r = 2.0 * i / (length - 1) - 1.0;
+            prototype[i] = sinc * besselI0(beta * std::sqrt(1.0 - r * r)) / besselI0(beta) * up;
+        }
+
+        // Branch p holds taps p, p + up, p + 2 * up, ... in order of increasing delay
+        taps.resize(static_cast<std::size_t>(up) * tapsPerPhase);
+        for (int p = 0; p < up; ++p) {
+            for (int k = 0; k < tapsPerPhase; ++k) {
+                taps[p * tapsPerPhase + k] = static_cast<float>(prototype[p + k * up]);
+            }
+        }
+        history.assign(tapsPerPhase - 1, 0.0f);
+    }
+
+    // Size the working buffer for chunks of up to maxCount inputs, so process() never
+    // allocates (it otherwise grows the buffer on first use)
+    void reserve(std::size_t maxCount) {
+        work.reserve(history.size() + maxCount);
+    }
+
+    // Streaming: consume count input samples, write the outputs produced and return how many.
+    // out needs room for outputCapacity(count) samples.
+    std::size_t process(const std::int16_t* in, std::size_t count, std::int16_t* out) {
+        std::size_t keep = history.size();
+        work.resize(keep + count);
+        for (std::size_t i = 0; i < keep; ++i) work[i] = history[i];
+        for (std::size_t i = 0; i < count; ++i) work[keep + i] = in[i];
+
+        std::size_t produced = 0;
+        while (position < count) {
+            out[produced++] = filter(&work[keep + position], 1, phase);
+            phase += down;
+            position += phase / up;
+            phase %= up;
+        }
+        position -= count;
+
+        for (std::size_t i = 0; i < keep; ++i) history[i] = work[count + i];
+        return produced;
+    }
+
+    // Random access for offline use: outputs [firstOutput, firstOutput + outputCount)
+    // of the stream input[0..inputCount), with zeros outside it. No state is touched,
+    // so independent ranges can be computed in parallel.
+    void processRange(const std::int16_t* input, std::size_t inputCount, std::uint64_t firstOutput,
+                      std::size_t outputCount, std::int16_t* out, int stride = 1) const {
+        std::vector<float> window(tapsPerPhase);
+        for (std::size_t n = 0; n < outputCount; ++n) {
+            std::uint64_t scaled = (firstOutput + n) * down;
+            long long base = static_cast<long long>(scaled / up);
+            int p = static_cast<int>(scaled % up);
+
+            if (base >= tapsPerPhase - 1 && base < static_cast<long long>(inputCount)) {
+                out[n] = filter(input + base * stride, stride, p);
+                continue;
+            }
+
+            // Near the ends: copy into a zero-padded window (newest sample last)
+            for (int k = 0; k < tapsPerPhase; ++k) {
+                long long index = base - k;
+                window[tapsPerPhase - 1 - k] = index >= 0 && index < static_cast<long long>(inputCount)
+                    ? input[index * stride] : 0.0f;
+            }
+            out[n] = filter(&window[tapsPerPhase - 1], 1, p);
+        }
+    }
+
+    // Upper bound on the outputs produced by count inputs
+    std::size_t outputCapacity(std::size_t count) const {
+        return count * up / down + 2;
+    }
+
+    int getInputRate() const {
+        return inRate;
+    }
+
+    int getOutputRate() const {
+        return outRate;
+    }
+
+    int getTapsPerPhase() const {
+        return tapsPerPhase;
+    }
+
+private:
+    // newest points at the most recent input sample; older ones are stride apart before it
+    template <typename Sample>
+    std::int16_t filter(const Sample* newest, int stride, int p) const {
+        const float* h = &taps[p * tapsPerPhase];
+        // Four independent accumulators so the multiply-adds overlap
+        float acc0 = 0.0f, acc1 = 0.0f, acc2 = 0.0f, acc3 = 0.0f;
+        int k = 0;
+        for (; k + 4 <= tapsPerPhase; k += 4) {
+            acc0 += h[k] * newest[-k * stride];
+            acc1 += h[k + 1] * newest[-(k + 1) * stride];
+            acc2 += h[k + 2] * newest[-(k + 2) * stride];
+            acc3 += h[k + 3] * newest[-(k + 3) * stride];
+        }
+        for (; k < tapsPerPhase; ++k) acc0 += h[k] * newest[-k * stride];
+        float acc = (acc0 + acc1) + (acc2 + acc3);
+        acc = std::floor(acc + 0.5f);
+        if (acc > 32767.0f) acc = 32767.0f;
+        if (acc < -32768.0f) acc = -32768.0f;
+        return static_cast<std::int16_t>(acc);
+    }
+
+    static long gcd(long a, long b) {
+        while (b != 0) {
+            long t = a % b;
+            a = b;
+            b = t;
+        }
+        return a;
+    }
+
+    // Modified Bessel function of the first kind, order 0 (for the Kaiser window)
+    static double besselI0(double x) {
+        double sum = 1.0, term = 1.0;
+        for (int k = 1; k < 50; ++k) {
+            term *= (x / (2 * k)) * (x / (2 * k));
+            sum += term;
+        }
+        return sum;
+    }
+
+    int inRate, outRate;
+    int up, down;
+    int tapsPerPhase;
+    std::vector<float> taps;
+    std::vector<float> history; // Last tapsPerPhase - 1 inputs
+    std::vector<float> work;
+    int phase;                  // Sub-sample position of the next output, in 1/up steps
+    std::size_t position;       // Input index of the next output, relative to the current call
+};
+
+// Wraps any source with read(int16*, count) and delivers it at the decimator's output rate
+template <typename Source>
+class DecimatedSource {
+public:
+    DecimatedSource(Source& source, Decimator& decimator, std::size_t chunk = 1024)
+        : source(source), decimator(decimator), input(chunk),
+          output(decimator.outputCapacity(chunk)), begin(0), end(0) {}
+
+    std::size_t read(std::int16_t* data, std::size_t count) {
+        std::size_t done = 0;
+        while (done < count) {
+            if (begin == end) {
+                std::size_t got = source.read(input.data(), input.size());
+                if (got == 0) break;
+                begin = 0;
+                end = decimator.process(input.data(), got, output.data());
+                continue;
+            }
+            std::size_t n = end - begin < count - done ? end - begin : count - done;
+            for (std::size_t i = 0; i < n; ++i) data[done + i] = output[begin + i];
+            begin += n;
+            done += n;
+        }
+        return done;
+    }
+
+private:
+    Source& source;
+    Decimator& decimator;
+    std::vector<std::int16_t> input;
+    std::vector<std::int16_t> output;
+    std::size_t begin, end; // Decimated samples not yet handed out
+};
+
+#endif
@@ -0,0 +1,140 @@
+#ifndef DTMF_HPP
+#define DTMF_HPP
+
+#include <array>
+
+// Shared DTMF tables. Everything here is built at compile time, so lookups on the
+// hot paths are plain array indexing: no std::map, no scans, no runtime trig.
+
+// DTMF row (low group) and column (high group) frequencies
+constexpr int DTMF_ROW_FREQS[4] = {697, 770, 852, 941};
+constexpr int DTMF_COL_FREQS[4] = {1209, 1336, 1477, 1633};
+
+// Symbol at [row][column]
+constexpr char DTMF_SYMBOLS[4][4] = {
+    {'1', '2', '3', 'A'},
+    {'4', '5', '6', 'B'},
+    {'7', '8', '9', 'C'},
+    {'*', '0', '#', 'D'}
+};
+
+// Tones are numbered 0-3 for the rows and 4-7 for the columns
+constexpr int dtmfToneFrequency(int tone) {
+    return tone < 4 ? DTMF_ROW_FREQS[tone] : DTMF_COL_FREQS[tone - 4];
+}
+
+// Symbol -> row * 4 + column, or -1 (indexed by ASCII code)
+constexpr std::array<signed char, 128> makePositionTable() {
+    std::array<signed char, 128> table{};
+    for (int i = 0; i < 128; ++i) table[i] = -1;
+    for (int row = 0; row < 4; ++row) {
+        for (int col = 0; col < 4; ++col) {
+            table[static_cast<int>(DTMF_SYMBOLS[row][col])] = static_cast<signed char>(row * 4 + col);
+        }
+    }
+    return table;
+}
+constexpr std::array<signed char, 128> DTMF_POSITIONS = makePositionTable();
+
+// Whole Hz -> tone index (0-7) for frequencies within the matching tolerance, or -1
+constexpr int DTMF_MAX_HZ = 2048;
+constexpr int DTMF_TOLERANCE_HZ = 20;
+constexpr std::array<signed char, DTMF_MAX_HZ> makeToneTable() {
+    std::array<signed char, DTMF_MAX_HZ> table{};
+    for (int hz = 0; hz < DTMF_MAX_HZ; ++hz) {
+        table[hz] = -1;
+        for (int tone = 0; tone < 8; ++tone) {
+            int diff = hz - dtmfToneFrequency(tone);
+            if (diff > -DTMF_TOLERANCE_HZ && diff < DTMF_TOLERANCE_HZ) table[hz] = static_cast<signed char>(tone);
+        }
+    }
+    return table;
+}
+constexpr std::array<signed char, DTMF_MAX_HZ> DTMF_TONE_AT_HZ = makeToneTable();
+
+constexpr int dtmfToneAt(int hz) {
+    return hz >= 0 && hz < DTMF_MAX_HZ ? DTMF_TONE_AT_HZ[hz] : -1;
+}
+
+// Row and column of a symbol; false if it is not one of the 16 DTMF symbols
+inline bool dtmfPosition(char symbol, int& row, int& col) {
+    int position = static_cast<unsigned char>(symbol) < 128 ? DTMF_POSITIONS[static_cast<unsigned char>(symbol)] : -1;
+    row = position >= 0 ? position / 4 : -1;
+    col = position >= 0 ? position % 4 : -1;
+    return position >= 0;
+}
+
+// Symbol for two detected frequencies in either order, or '\0'
+inline char dtmfSymbolAt(int freq1, int freq2) {
+    int tone1 = dtmfToneAt(freq1), tone2 = dtmfToneAt(freq2);
+    if (tone1 < 0 || tone2 < 0 || (tone1 < 4) == (tone2 < 4)) return '\0';
+    if (tone1 > tone2) {
+        int t = tone1;
+        tone1 = tone2;
+        tone2 = t;
+    }
+    return DTMF_SYMBOLS[tone1][tone2 - 4];
+}
+
+// cos(x) usable in constant expressions (range reduction + Taylor series)
+constexpr double constexprCos(double x) {
+    const double pi = 3.14159265358979323846;
+    while (x > pi) x -= 2 * pi;
+    while (x < -pi) x += 2 * pi;
+    double term = 1.0, sum = 1.0;
+    for (int n = 1; n < 30; ++n) {
+        term *= -x * x / ((2 * n - 1) * (2 * n));
+        sum += term;
+    }
+    return sum;
+}
+
+constexpr double constexprSin(double x) {
+    return constexprCos(x - 3.14159265358979323846 / 2);
+}
+
+// Per-sample-rate coefficients: Goertzel 2cos(w) for the 8 tones and their second
+// harmonics, and cos/sin(w) for recursive (rotating phasor) oscillators
+template <int SampleRate>
+struct DTMFCoefficients {
+    static constexpr double omega(int freq) {
+        return 2 * 3.14159265358979323846 * freq / SampleRate;
+    }
+    static constexpr std::array<double, 8> makeGoertzel(int harmonic) {
+        std::array<double, 8> coeff{};
+        for (int tone = 0; tone < 8; ++tone) coeff[tone] = 2 * constexprCos(omega(harmonic * dtmfToneFrequency(tone)));
+        return coeff;
+    }
+    static constexpr std::array<double, 8> makeCos() {
+        std::array<double, 8> c{};
+        for (int tone = 0; tone < 8; ++tone) c[tone] = constexprCos(omega(dtmfToneFrequency(tone)));
+        return c;
+    }
+    static constexpr std::array<double, 8> makeSin() {
+        std::array<double, 8> s{};
+        for (int tone = 0; tone < 8; ++tone) s[tone] = constexprSin(omega(dtmfToneFrequency(tone)));
+        return s;
+    }
+
+    static constexpr std::array<double, 8> goertzel = makeGoertzel(1);
+    static constexpr std::array<double, 8> goertzelHarmonic = makeGoertzel(2);
+    static constexpr std::array<double, 8> oscillatorCos = makeCos();
+    static constexpr std::array<double, 8> oscillatorSin = makeSin();
+};
+
+// Per-frame tables: which FFT bin of a FrameSize-point transform falls on which tone
+template <int SampleRate, int FrameSize>
+struct DTMFFrameTables {
+    static constexpr std::array<signed char, FrameSize / 2> makeBinTones() {
+        std::array<signed char, FrameSize / 2> table{};
+        for (int bin = 0; bin < FrameSize / 2; ++bin) {
+            table[bin] = static_cast<signed char>(dtmfToneAt(static_cast<int>(static_cast<long>(bin) * SampleRate / FrameSize)));
+        }
+        return table;
+    }
+
+    static constexpr std::array<signed char, FrameSize / 2> binTone = makeBinTones();
+    static constexpr double binHz = static_cast<double>(SampleRate) / FrameSize;
+};
+
+#endif
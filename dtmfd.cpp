@@ -0,0 +1,739 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <map>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "protocol.hpp"
+#include "receiver.hpp"
+#include "ringbuffer.hpp"
+#include "synth.hpp"
+#include "telemetry.hpp"
+#include "workpool.hpp"
+
+const char* const DEFAULT_SOCKET = "/tmp/dtmfd.sock";
+const int STREAM_QUEUE = 1 << 18;       // Samples buffered per stream (~5 s at 48 kHz) before reads pause
+const std::size_t READ_BYTES = 65536;   // Largest single read from a producer
+const std::size_t TASK_SAMPLES = 16384; // Samples one task decodes before the stream goes back in the queue
+const std::size_t MAX_HEADER = 64;
+const int MIN_RATE = RECEIVER_DETECT_RATE;
+const int MAX_RATE = 192000;
+const std::size_t REPLY_BUFFER = 65536; // Reply bytes queued per stream for a reader that falls behind
+const double MAX_TONE_GAP = 1.0;        // Seconds between tones of one message, as in DTMF5
+
+// Bench signal
+const int BENCH_AMPLITUDE = 20000;
+const double BENCH_TONE = 0.1;   // Seconds
+const double BENCH_GAP = 0.1;
+const int BENCH_CHUNKS_PER_SECOND = 100; // Producer write size in real-time mode (10 ms)
+
+// Multi-stream DTMF decoding service.
+//
+// Producers connect to a UNIX stream socket (or write into a FIFO named on the
+// command line) and send one header line, "DTMF <rate>[ link]\n", then raw 16-bit
+// little-endian mono PCM. Every tone and every decoded command goes back on the same
+// connection as a text line:
+//
+//   T <symbol> <sample>            tone onset, at the capture sample it was recognised
+//   C <command> <start> <end>      DTMF2 command (or link frame commands) and its span
+//
+// One thread owns all file descriptors (epoll) and only moves bytes between them and
+// per-stream queues; decoding runs as tasks on a work-stealing pool. A stream has at
+// most one task queued or running at a time, so its receiver state needs no lock, and
+// a task decodes at most TASK_SAMPLES before requeueing the stream behind the others.
+// Tasks never wait on a reader: a connection that lets REPLY_BUFFER bytes of replies
+// pile up stops getting them, and a FIFO loses the lines that do not fit.
+
+volatile std::sig_atomic_t stopRequested = 0;
+
+void onSignal(int) {
+    stopRequested = 1;
+}
+
+// One producer: its input queue, detector state and reply buffer
+struct Stream {
+    int id;
+    int inFd;
+    int outFd;          // Same as inFd for sockets
+    bool socket;        // A socket that stops reading loses its replies; FIFO lines are dropped while nobody reads
+    std::string header; // Until the header line is complete
+    bool started;
+    int rate;
+    bool link;
+    std::unique_ptr<DTMFReceiver> receiver;
+    SpscRingBuffer<std::int16_t> queue; // I/O thread writes, the stream's task reads
+    SpscRingBuffer<char> outbox;        // The stream's task writes replies, the I/O thread sends them
+    unsigned char carry[1];             // Odd byte left over from the last read
+    bool hasCarry;
+
+    std::atomic<bool> scheduled;   // A task for this stream is queued or running
+    std::atomic<bool> paused;      // Queue was full, reads stopped until the task drains it (I/O thread sets and clears)
+    std::atomic<bool> closed;      // Producer hung up; the last task finishes the stream
+    std::atomic<bool> finished;    // Last task done; the I/O thread retires the stream once its replies are out
+    std::atomic<bool> replyFailed; // Reader gone or stuck: keep decoding, stop replying
+    std::atomic<bool> woken;       // Already on the I/O thread's wake list
+    std::chrono::steady_clock::time_point submitted;
+
+    // Task side only
+    std::size_t budget;
+    CommandDecoder decoder;
+    LinkDecoder linkDecoder;
+    std::string reply;
+    std::uint64_t tones;
+    std::uint64_t commands;
+    TelemetryHistogram latencyUs; // Task queued -> task done
+
+    // I/O thread only
+    std::string sending;     // Taken from the outbox, not yet accepted by the reader
+    std::uint32_t inEvents;  // What epoll watches on inFd (0: not registered)
+    std::uint32_t outEvents; // Same for outFd when it is a separate FIFO
+    bool inputDone;
+    bool retired;
+
+    Stream(int id, int inFd, int outFd, bool socket)
+        : id(id), inFd(inFd), outFd(outFd), socket(socket), started(false), rate(0), link(false), queue(STREAM_QUEUE),
+          outbox(REPLY_BUFFER), hasCarry(false), scheduled(false), paused(false), closed(false), finished(false),
+          replyFailed(false), woken(false), budget(0), decoder(0), linkDecoder(0), tones(0), commands(0), inEvents(0),
+          outEvents(0), inputDone(false), retired(false) {}
+
+    ~Stream() {
+        if (outFd >= 0 && outFd != inFd) close(outFd);
+        if (inFd >= 0) close(inFd);
+    }
+
+    // Parse "DTMF <rate>[ link]" and set up the receiver
+    bool begin(const std::string& line) {
+        char mode[16] = "";
+        if (std::sscanf(line.c_str(), "DTMF %d %15s", &rate, mode) < 1) return false;
+        if (rate < MIN_RATE || rate > MAX_RATE) return false;
+        link = std::strcmp(mode, "link") == 0;
+        if (!link && mode[0] != '\0') return false;
+
+        receiver.reset(new DTMFReceiver(rate, RECEIVER_HOP, receiverSliding(false, link)));
+        decoder = CommandDecoder(static_cast<std::uint64_t>(MAX_TONE_GAP * rate));
+        linkDecoder = LinkDecoder(static_cast<std::uint64_t>(rate) * LINK_MAX_GAP_MS / 1000);
+        started = true;
+        return true;
+    }
+
+    // Source for DTMFReceiver::poll: the queue, up to this task's budget
+    std::size_t read(std::int16_t* samples, std::size_t count) {
+        if (count > budget) count = budget;
+        count = queue.read(samples, count);
+        budget -= count;
+        return count;
+    }
+
+    void operator()(const ReceiverFrame& frame) {
+        if (!frame.onset) return;
+        ++tones;
+        char line[96];
+        std::snprintf(line, sizeof(line), "T %c %llu\n", frame.symbol, static_cast<unsigned long long>(frame.sampleIndex));
+        reply += line;
+
+        if (link) {
+            LinkFrame received;
+            if (!linkDecoder.push(frame.symbol, frame.sampleIndex, received)) return;
+            commands += received.commands.size();
+            reply += "C " + received.commands + " " + std::to_string(received.start) + " " + std::to_string(received.end) + "\n";
+        } else {
+            ReceivedCommand command;
+            if (!decoder.push(frame.symbol, frame.sampleIndex, command)) return;
+            ++commands;
+            reply += std::string("C ") + command.command + " " + std::to_string(command.start) + " " +
+                     std::to_string(command.end) + "\n";
+        }
+    }
+
+    // Hand what the last poll produced to the I/O thread, whole lines or nothing; never
+    // waits on the reader. Returns true if the I/O thread has something new to do.
+    bool flush() {
+        bool changed = false;
+        if (!reply.empty() && !replyFailed.load()) {
+            if (outbox.capacity() - outbox.size() >= reply.size()) {
+                outbox.write(reply.data(), reply.size());
+                changed = true;
+            } else if (socket) {
+                replyFailed.store(true); // REPLY_BUFFER behind: the reader is stuck
+                changed = true;
+            } // A FIFO nobody reads: these lines are lost
+        }
+        reply.clear();
+        return changed;
+    }
+};
+
+// The daemon: epoll loop over the listening socket, the FIFOs and every connection.
+// Only the I/O thread touches epoll and writes replies; a task that has replies or
+// has drained a paused queue puts its stream on the wake list and signals an eventfd.
+class DecodeServer {
+public:
+    // verbose logs a summary line per stream when it ends
+    DecodeServer(unsigned workers, bool verbose)
+        : pool(new WorkStealingPool(workers)), epollFd(epoll_create1(0)), wakeFd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)),
+          listenFd(-1), nextId(0), verbose(verbose), stopping(false) {
+        watch(wakeFd, EPOLLIN);
+    }
+
+    ~DecodeServer() {
+        pool.reset(); // Runs the tasks still queued
+        for (auto& entry : streams) sendReplies(*entry.second); // Whatever the readers take now
+        if (listenFd >= 0) {
+            close(listenFd);
+            unlink(socketPath.c_str());
+        }
+        if (wakeFd >= 0) close(wakeFd);
+        if (epollFd >= 0) close(epollFd);
+    }
+
+    DecodeServer(const DecodeServer&) = delete;
+    DecodeServer& operator=(const DecodeServer&) = delete;
+
+    bool listenOn(const std::string& path) {
+        sockaddr_un address;
+        std::memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(address.sun_path)) return false;
+        std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+        unlink(path.c_str()); // Left behind by a previous run
+        listenFd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0);
+        if (listenFd < 0 || bind(listenFd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 ||
+            listen(listenFd, 128) != 0) {
+            return false;
+        }
+        socketPath = path;
+        return watch(listenFd, EPOLLIN);
+    }
+
+    // A long-lived stream through a FIFO pair. Both ends are opened read-write so
+    // neither open blocks and the input never sees end-of-file between producers.
+    bool addFifo(const std::string& inPath, const std::string& outPath) {
+        if ((mkfifo(inPath.c_str(), 0600) != 0 && errno != EEXIST) || (mkfifo(outPath.c_str(), 0600) != 0 && errno != EEXIST)) {
+            return false;
+        }
+        int inFd = open(inPath.c_str(), O_RDWR | O_NONBLOCK);
+        int outFd = open(outPath.c_str(), O_RDWR | O_NONBLOCK);
+        if (inFd < 0 || outFd < 0) {
+            if (inFd >= 0) close(inFd);
+            if (outFd >= 0) close(outFd);
+            return false;
+        }
+        std::shared_ptr<Stream> stream(new Stream(nextId++, inFd, outFd, false));
+        streams[inFd] = stream;
+        streams[outFd] = stream;
+        return setInterest(inFd, stream->inEvents, EPOLLIN | EPOLLRDHUP);
+    }
+
+    // Serve until stop() or a signal; connections still open are decoded to the end of
+    // what has arrived
+    void run() {
+        epoll_event events[64];
+        while (!stopping.load(std::memory_order_relaxed) && !stopRequested) {
+            int count = epoll_wait(epollFd, events, 64, 200);
+            for (int i = 0; i < count; ++i) {
+                int fd = events[i].data.fd;
+                std::uint32_t flags = events[i].events;
+                if (fd == listenFd) {
+                    acceptAll();
+                    continue;
+                }
+                if (fd == wakeFd) {
+                    wakeUp();
+                    continue;
+                }
+                auto found = streams.find(fd);
+                if (found == streams.end()) continue;
+                std::shared_ptr<Stream> stream = found->second; // Outlives a hang-up erasing the entry
+                if (fd == stream->outFd && (flags & (EPOLLOUT | EPOLLHUP | EPOLLERR))) sendReplies(*stream);
+                if (fd == stream->inFd && !stream->inputDone && !stream->paused.load() &&
+                    (flags & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))) {
+                    readStream(stream);
+                }
+                update(stream);
+            }
+        }
+    }
+
+    void stop() {
+        stopping.store(true, std::memory_order_relaxed);
+    }
+
+    WorkStealingPool& getPool() {
+        return *pool;
+    }
+
+private:
+    bool watch(int fd, std::uint32_t events) {
+        epoll_event event;
+        std::memset(&event, 0, sizeof(event));
+        event.events = events;
+        event.data.fd = fd;
+        return epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) == 0;
+    }
+
+    // Bring fd's registration to events, 0 meaning not registered at all: with an empty
+    // mask epoll would still report hang-ups and errors, level-triggered, on every wait
+    bool setInterest(int fd, std::uint32_t& current, std::uint32_t events) {
+        if (events == current) return true;
+        epoll_event event;
+        std::memset(&event, 0, sizeof(event));
+        event.events = events;
+        event.data.fd = fd;
+        int op = events == 0 ? EPOLL_CTL_DEL : current == 0 ? EPOLL_CTL_ADD : EPOLL_CTL_MOD;
+        current = events;
+        return epoll_ctl(epollFd, op, fd, &event) == 0;
+    }
+
+    // Watch what the stream needs now: input unless it is paused or done, output while
+    // replies are waiting. A finished stream is retired once they are out.
+    void update(const std::shared_ptr<Stream>& stream) {
+        if (stream->retired) return;
+        bool replies = !stream->replyFailed.load() && (!stream->sending.empty() || stream->outbox.size() > 0);
+        if (stream->finished.load() && !replies) {
+            retire(stream);
+            return;
+        }
+        std::uint32_t input = stream->inputDone || stream->paused.load() ? 0 : EPOLLIN | EPOLLRDHUP;
+        std::uint32_t output = replies ? static_cast<std::uint32_t>(EPOLLOUT) : 0;
+        if (stream->outFd == stream->inFd) {
+            setInterest(stream->inFd, stream->inEvents, input | output);
+        } else {
+            setInterest(stream->inFd, stream->inEvents, input);
+            setInterest(stream->outFd, stream->outEvents, output);
+        }
+    }
+
+    void acceptAll() {
+        int fd;
+        while ((fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+            std::shared_ptr<Stream> stream(new Stream(nextId++, fd, fd, true));
+            streams[fd] = stream;
+            setInterest(fd, stream->inEvents, EPOLLIN | EPOLLRDHUP);
+        }
+    }
+
+    // One read per readiness event; epoll is level-triggered, so the rest comes next time
+    void readStream(const std::shared_ptr<Stream>& stream) {
+        unsigned char buffer[READ_BYTES];
+        std::size_t want = READ_BYTES;
+        if (stream->started) {
+            std::size_t space = stream->queue.capacity() - stream->queue.size();
+            if (space == 0) {
+                // Stop reading until the task has drained the queue and woken this thread
+                // (update() drops the input interest)
+                stream->paused.store(true, std::memory_order_seq_cst);
+                schedule(stream);
+                return;
+            }
+            want = std::min(want, space * sizeof(std::int16_t) - (stream->hasCarry ? 1 : 0));
+        }
+
+        ssize_t got = read(stream->inFd, buffer, want);
+        if (got < 0 && (errno == EAGAIN || errno == EINTR)) return;
+        if (got <= 0) {
+            hangUp(stream);
+            return;
+        }
+
+        std::size_t used = 0;
+        if (!stream->started) {
+            // Header line, possibly followed by the first samples
+            while (used < static_cast<std::size_t>(got) && buffer[used] != '\n') stream->header += buffer[used++];
+            if (used == static_cast<std::size_t>(got)) {
+                if (stream->header.size() > MAX_HEADER) refuse(stream);
+                return;
+            }
+            ++used;
+            if (!stream->begin(stream->header)) {
+                refuse(stream);
+                return;
+            }
+        }
+        enqueue(*stream, buffer + used, got - used);
+        schedule(stream);
+    }
+
+    // Bytes to samples, carrying an odd byte over to the next read
+    void enqueue(Stream& stream, const unsigned char* bytes, std::size_t count) {
+        std::int16_t samples[READ_BYTES / sizeof(std::int16_t) + 1];
+        std::size_t n = 0;
+        if (stream.hasCarry && count > 0) {
+            samples[n++] = static_cast<std::int16_t>(stream.carry[0] | bytes[0] << 8);
+            ++bytes;
+            --count;
+            stream.hasCarry = false;
+        }
+        for (; count >= 2; bytes += 2, count -= 2) samples[n++] = static_cast<std::int16_t>(bytes[0] | bytes[1] << 8);
+        if (count == 1) {
+            stream.carry[0] = bytes[0];
+            stream.hasCarry = true;
+        }
+        stream.queue.write(samples, n); // Read size was capped to the free space
+    }
+
+    // Write queued replies until the reader stops taking them
+    void sendReplies(Stream& stream) {
+        char buffer[4096];
+        while (!stream.replyFailed.load()) {
+            if (stream.sending.empty()) {
+                std::size_t count = stream.outbox.read(buffer, sizeof(buffer));
+                if (count == 0) return;
+                stream.sending.assign(buffer, count);
+            }
+            ssize_t n = write(stream.outFd, stream.sending.data(), stream.sending.size());
+            if (n > 0) {
+                stream.sending.erase(0, n);
+                continue;
+            }
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return; // The rest on EPOLLOUT
+            stream.replyFailed.store(true); // Reader gone
+        }
+        stream.sending.clear();
+        stream.outbox.skip(stream.outbox.size());
+    }
+
+    // Streams whose tasks asked for the I/O thread: replies to send, a paused queue
+    // with room again, or a finished stream to retire
+    void wakeUp() {
+        std::uint64_t count;
+        if (read(wakeFd, &count, sizeof(count)) < 0) {
+            // Already drained
+        }
+        std::vector<std::shared_ptr<Stream> > ready;
+        {
+            std::lock_guard<std::mutex> guard(wakeLock);
+            ready.swap(wakeList);
+        }
+        for (const std::shared_ptr<Stream>& stream : ready) {
+            stream->woken.store(false, std::memory_order_seq_cst); // Before looking, so no request is missed
+            if (stream->retired) continue;
+            if (stream->paused.load() && stream->queue.size() < stream->queue.capacity()) stream->paused.store(false);
+            sendReplies(*stream); // Also discards the queue once replies have failed
+            update(stream);
+        }
+    }
+
+    // Task side: ask the I/O thread to look at the stream
+    void wake(const std::shared_ptr<Stream>& stream) {
+        if (stream->woken.exchange(true, std::memory_order_seq_cst)) return;
+        {
+            std::lock_guard<std::mutex> guard(wakeLock);
+            wakeList.push_back(stream);
+        }
+        std::uint64_t one = 1;
+        if (write(wakeFd, &one, sizeof(one)) < 0) {
+            // Counter saturated: the I/O thread is already due to wake
+        }
+    }
+
+    void refuse(const std::shared_ptr<Stream>& stream) {
+        static const char message[] = "E expected \"DTMF <rate>[ link]\" header\n";
+        if (write(stream->outFd, message, sizeof(message) - 1) < 0) {
+            // Producer already gone
+        }
+        hangUp(stream);
+    }
+
+    // The producer is done: stop reading it and let its last task finish it off. Its
+    // replies are still sent until then.
+    void hangUp(const std::shared_ptr<Stream>& stream) {
+        stream->inputDone = true;
+        stream->closed.store(true, std::memory_order_seq_cst);
+        if (stream->started) {
+            update(stream);
+            schedule(stream);
+        } else {
+            retire(stream);
+        }
+    }
+
+    // All replies are out (or given up on): forget the stream and, for a socket, let
+    // the producer see end-of-file
+    void retire(const std::shared_ptr<Stream>& stream) {
+        stream->retired = true;
+        setInterest(stream->inFd, stream->inEvents, 0);
+        streams.erase(stream->inFd);
+        if (stream->outFd != stream->inFd) {
+            setInterest(stream->outFd, stream->outEvents, 0);
+            streams.erase(stream->outFd);
+        }
+        if (stream->socket) shutdown(stream->inFd, SHUT_RDWR);
+    }
+
+    void schedule(const std::shared_ptr<Stream>& stream) {
+        std::atomic_thread_fence(std::memory_order_seq_cst); // Samples written before the flag is tested
+        if (stream->scheduled.exchange(true, std::memory_order_seq_cst)) return;
+        submit(stream);
+    }
+
+    void submit(const std::shared_ptr<Stream>& stream) {
+        stream->submitted = std::chrono::steady_clock::now();
+        pool->submit([this, stream]() { decode(stream); });
+    }
+
+    // Worker side: decode one slice of the stream. Never blocks: replies go to the
+    // outbox and the I/O thread sends them.
+    void decode(const std::shared_ptr<Stream>& stream) {
+        stream->budget = TASK_SAMPLES;
+        stream->receiver->poll(*stream, *stream);
+        bool replied = stream->flush();
+        stream->latencyUs.record(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - stream->submitted).count());
+
+        if (replied || stream->paused.load(std::memory_order_seq_cst)) wake(stream);
+        if (stream->queue.size() > 0) {
+            submit(stream); // Still scheduled; back of this worker's queue
+            return;
+        }
+
+        // Unschedule, then look again: the I/O thread may have added samples, or paused
+        // the stream, after the queue was found empty but before it could see the flag
+        // cleared. Either it sees the flag cleared and schedules a new task, or this one
+        // sees what it did.
+        stream->scheduled.store(false, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (stream->paused.load(std::memory_order_seq_cst)) wake(stream);
+        if (stream->queue.size() > 0) {
+            if (!stream->scheduled.exchange(true, std::memory_order_seq_cst)) submit(stream);
+            return;
+        }
+        if (stream->closed.load(std::memory_order_seq_cst) && !stream->scheduled.exchange(true, std::memory_order_seq_cst)) {
+            finish(stream); // Stays "scheduled" so nothing runs after this
+        }
+    }
+
+    void finish(const std::shared_ptr<Stream>& stream) {
+        stream->finished.store(true, std::memory_order_seq_cst);
+        wake(stream); // The I/O thread retires it once the replies are out
+        if (!verbose) return;
+        char line[256];
+        std::snprintf(line, sizeof(line), "Stream %d: %.1f s of audio at %d Hz, %llu tones, %llu commands, "
+                      "queue+decode p50 %llu us p99 %llu us\n", stream->id,
+                      static_cast<double>(stream->receiver->getSampleCount()) / stream->rate, stream->rate,
+                      static_cast<unsigned long long>(stream->tones), static_cast<unsigned long long>(stream->commands),
+                      static_cast<unsigned long long>(stream->latencyUs.quantile(0.5)),
+                      static_cast<unsigned long long>(stream->latencyUs.quantile(0.99)));
+        std::cerr << line;
+    }
+
+    std::unique_ptr<WorkStealingPool> pool;
+    int epollFd;
+    int wakeFd;
+    int listenFd;
+    std::string socketPath;
+    std::map<int, std::shared_ptr<Stream> > streams; // By input and output fd; I/O thread only
+    std::mutex wakeLock;
+    std::vector<std::shared_ptr<Stream> > wakeList;  // Streams a task asked the I/O thread to look at
+    int nextId;
+    bool verbose;
+    std::atomic<bool> stopping;
+};
+
+// Bench producer: streams a signal into the daemon and collects what comes back.
+// In real-time mode it writes 10 ms at a time on the clock and measures each tone's
+// latency from the write that completed the tone's decision frame to its reply.
+struct BenchClient {
+    std::string symbols;            // Tones received
+    std::vector<double> latencyMs;  // Real-time mode only
+    bool ok;
+
+    BenchClient() : ok(false) {}
+
+    void run(const std::string& path, const std::vector<std::int16_t>& signal, int rate, bool realtime) {
+        sockaddr_un address;
+        std::memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+        int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0 || connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+            if (fd >= 0) close(fd);
+            return;
+        }
+
+        std::size_t chunk = rate / BENCH_CHUNKS_PER_SECOND;
+        std::size_t chunks = (signal.size() + chunk - 1) / chunk;
+        std::vector<std::atomic<std::int64_t> > sentAt(chunks); // Nanoseconds, steady clock
+
+        std::thread reader([&]() {
+            std::string pending;
+            char buffer[4096];
+            ssize_t got;
+            while ((got = read(fd, buffer, sizeof(buffer))) > 0) {
+                std::int64_t now = std::chrono::steady_clock::now().time_since_epoch().count();
+                pending.append(buffer, got);
+                std::size_t end;
+                while ((end = pending.find('\n')) != std::string::npos) {
+                    char symbol;
+                    unsigned long long sample;
+                    if (std::sscanf(pending.c_str(), "T %c %llu", &symbol, &sample) == 2) {
+                        symbols += symbol;
+                        std::size_t index = sample > 0 ? (sample - 1) / chunk : 0;
+                        if (realtime && index < chunks) latencyMs.push_back((now - sentAt[index].load()) / 1e6);
+                    }
+                    pending.erase(0, end + 1);
+                }
+            }
+        });
+
+        std::string header = "DTMF " + std::to_string(rate) + "\n";
+        bool written = write(fd, header.data(), header.size()) == static_cast<ssize_t>(header.size());
+        auto start = std::chrono::steady_clock::now();
+        for (std::size_t c = 0; written && c < chunks; ++c) {
+            if (realtime) std::this_thread::sleep_until(start + std::chrono::microseconds(c * 1000000 / BENCH_CHUNKS_PER_SECOND));
+            std::size_t first = c * chunk, count = std::min(chunk, signal.size() - first);
+            const char* bytes = reinterpret_cast<const char*>(&signal[first]); // Little-endian host
+            std::size_t size = count * sizeof(std::int16_t), sent = 0;
+            sentAt[c].store(std::chrono::steady_clock::now().time_since_epoch().count());
+            while (sent < size) {
+                ssize_t n = write(fd, bytes + sent, size - sent);
+                if (n <= 0) {
+                    written = false;
+                    break;
+                }
+                sent += n;
+            }
+        }
+        shutdown(fd, SHUT_WR);
+        reader.join();
+        close(fd);
+        ok = written;
+    }
+};
+
+double percentile(std::vector<double> values, double p) {
+    if (values.empty()) return 0.0;
+    std::sort(values.begin(), values.end());
+    return values[static_cast<std::size_t>(p * (values.size() - 1) + 0.5)];
+}
+
+// Run streams producers against an in-process daemon with the given worker count
+int runBench(const std::string& path, unsigned workers, int streams, double seconds, int rate, bool realtime) {
+    std::mt19937 rng(1);
+    DTMFSynth synth(rate, BENCH_AMPLITUDE);
+    std::string expected;
+    for (int i = 0; i < static_cast<int>(seconds / (BENCH_TONE + BENCH_GAP)); ++i) expected += DTMF_SYMBOLS[rng() % 4][rng() % 4];
+    std::vector<std::int16_t> signal;
+    synth.renderSequence(expected, static_cast<std::size_t>(BENCH_TONE * rate), static_cast<std::size_t>(BENCH_GAP * rate), signal);
+
+    std::vector<BenchClient> clients(streams);
+    double elapsed;
+    std::uint64_t steals;
+    {
+        DecodeServer server(workers, false);
+        if (!server.listenOn(path)) {
+            std::cerr << "Cannot listen on " << path << "\n";
+            return -1;
+        }
+        std::thread io([&]() { server.run(); });
+
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> producers;
+        for (int s = 0; s < streams; ++s) {
+            producers.push_back(std::thread([&, s]() { clients[s].run(path, signal, rate, realtime); }));
+        }
+        for (auto& producer : producers) producer.join();
+        elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        steals = server.getPool().getSteals();
+        server.stop();
+        io.join();
+    }
+
+    int failures = 0;
+    std::vector<double> latency, streamP99;
+    for (const BenchClient& client : clients) {
+        if (!client.ok || client.symbols != expected) ++failures;
+        latency.insert(latency.end(), client.latencyMs.begin(), client.latencyMs.end());
+        streamP99.push_back(percentile(client.latencyMs, 0.99));
+    }
+    double audioSeconds = static_cast<double>(signal.size()) / rate * streams;
+    std::printf("%u workers, %d streams: %.0f s of audio in %.2f s (%.1fx real time), %d streams wrong, %llu steals\n",
+                workers, streams, audioSeconds, elapsed, audioSeconds / elapsed, failures,
+                static_cast<unsigned long long>(steals));
+    if (realtime) {
+        std::printf("  tone latency p50 %.2f ms, p99 %.2f ms, worst stream p99 %.2f ms\n", percentile(latency, 0.5),
+                    percentile(latency, 0.99), *std::max_element(streamP99.begin(), streamP99.end()));
+    }
+    std::fflush(stdout);
+    return failures == 0 ? 0 : 1;
+}
+
+int main(int argc, char* argv[]) {
+    // dtmfd [--socket PATH] [--fifo IN:OUT]... [--workers N]
+    // dtmfd --bench STREAMS [--seconds S] [--rate HZ] [--realtime] [--scaling] [--workers N]
+    std::string socketPath = DEFAULT_SOCKET;
+    std::vector<std::string> fifos;
+    unsigned workers = std::thread::hardware_concurrency();
+    if (workers == 0) workers = 1;
+    int benchStreams = 0, rate = 16000;
+    double seconds = 30.0;
+    bool realtime = false, scaling = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--socket") == 0 && i + 1 < argc) socketPath = argv[++i];
+        else if (std::strcmp(argv[i], "--fifo") == 0 && i + 1 < argc) fifos.push_back(argv[++i]);
+        else if (std::strcmp(argv[i], "--workers") == 0 && i + 1 < argc) workers = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--bench") == 0 && i + 1 < argc) benchStreams = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) seconds = std::atof(argv[++i]);
+        else if (std::strcmp(argv[i], "--rate") == 0 && i + 1 < argc) rate = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--realtime") == 0) realtime = true;
+        else if (std::strcmp(argv[i], "--scaling") == 0) scaling = true;
+        else {
+            std::cerr << "Usage: dtmfd [--socket PATH] [--fifo IN:OUT]... [--workers N]\n"
+                      << "       dtmfd --bench STREAMS [--seconds S] [--rate HZ] [--realtime] [--scaling] [--workers N]\n";
+            return -1;
+        }
+    }
+    if (workers == 0 || workers > 1024 || rate < MIN_RATE || rate > MAX_RATE || seconds <= 0.0) {
+        std::cerr << "Workers must be 1-1024, rate " << MIN_RATE << "-" << MAX_RATE << " Hz, seconds positive\n";
+        return -1;
+    }
+    std::signal(SIGPIPE, SIG_IGN); // A producer that hangs up fails the write instead
+
+    if (benchStreams > 0) {
+        // --scaling repeats the run with 1, 2, 4, ... workers up to --workers
+        std::vector<unsigned> counts;
+        for (unsigned w = 1; scaling && w < workers; w *= 2) counts.push_back(w);
+        counts.push_back(workers);
+        int status = 0;
+        for (unsigned w : counts) status |= runBench(socketPath, w, benchStreams, seconds, rate, realtime);
+        return status;
+    }
+
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+    DecodeServer server(workers, true);
+    if (!server.listenOn(socketPath)) {
+        std::cerr << "Cannot listen on " << socketPath << ": " << std::strerror(errno) << "\n";
+        return -1;
+    }
+    for (const std::string& pair : fifos) {
+        std::size_t colon = pair.find(':');
+        if (colon == std::string::npos || !server.addFifo(pair.substr(0, colon), pair.substr(colon + 1))) {
+            std::cerr << "Cannot open FIFO pair " << pair << " (expected IN:OUT)\n";
+            return -1;
+        }
+    }
+    std::cerr << "Listening on " << socketPath << " with " << workers << " workers\n";
+    server.run();
+    return 0;
+}
+
+// g++ dtmfd.cpp -o dtmfd -O2 -pthread -std=c++17
@@ -0,0 +1,141 @@
+#ifndef FFTDETECTOR_HPP
+#define FFTDETECTOR_HPP
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include "dtmf.hpp"
+#include "goertzel.hpp"
+#include "fftworkspace.hpp"
+
+// Bands searched for the row and column peaks (Hz)
+const double FFT_ROW_BAND[2] = {650.0, 1000.0};
+const double FFT_COL_BAND[2] = {1150.0, 1700.0};
+
+// Small-frame FFT detector.
+// DTMF4 reads frequencies off whole bins, so a bin has to be narrower than the 20 Hz
+// matching tolerance and frames have to be thousands of samples long. Here the frame
+// is windowed and the strongest bin in each DTMF band is refined with Jacobsen's
+// three-bin estimator, which places a tone to a small fraction of a bin, so 256-512
+// sample frames match just as well. Only the two bands are searched and everything
+// is compared as squared magnitudes: no sqrt anywhere. The validity checks mirror the
+// Goertzel detectors' (tone share of the frame energy, twist, second harmonics),
+// measured over each peak's main lobe.
+class FFTToneDetector {
+public:
+    FFTToneDetector(int sampleRate, int frameSize, FFTWindow window = WINDOW_HANN, const std::string& wisdomFile = "",
+                    unsigned flags = FFTW_MEASURE, const GoertzelThresholds& thresholds = GoertzelThresholds())
+        : fft(frameSize, wisdomFile, flags), thresholds(thresholds), binHz(static_cast<double>(sampleRate) / frameSize),
+          rowHz(0), colHz(0) {
+        fft.setWindow(window);
+
+        // Main lobe half-width in bins, and the estimator's bias correction for the window
+        lobe = window == WINDOW_HANN ? 2 : window == WINDOW_BLACKMAN_HARRIS ? 3 : 1;
+        correction = window == WINDOW_HANN ? 2.0 : window == WINDOW_BLACKMAN_HARRIS ? 3.16 : 1.0;
+
+        rowBins[0] = binAt(FFT_ROW_BAND[0], 1);
+        rowBins[1] = binAt(FFT_ROW_BAND[1], 0);
+        colBins[0] = binAt(FFT_COL_BAND[0], 1);
+        colBins[1] = binAt(FFT_COL_BAND[1], 0);
+    }
+
+    char detect(const std::int16_t* frame) {
+        int size = fft.getSize();
+        double energy = fft.execute(frame, size);
+        rowHz = colHz = 0;
+        if (energy <= 0.0) return '\0';
+
+        int row = peakBin(rowBins[0], rowBins[1]);
+        int col = peakBin(colBins[0], colBins[1]);
+        rowHz = static_cast<int>((row + peakOffset(row)) * binHz + 0.5);
+        colHz = static_cast<int>((col + peakOffset(col)) * binHz + 0.5);
+        char symbol = dtmfSymbolAt(rowHz, colHz);
+        if (symbol == '\0') return '\0';
+
+        // The main lobes hold a pure tone's power; a windowed frame's bins hold size times
+        // its energy, half of it in the positive-frequency bins
+        double rowPower = lobePower(row), colPower = lobePower(col);
+        double toneShare = 2.0 * (rowPower + colPower) / (static_cast<double>(size) * energy);
+        if (toneShare < thresholds.minToneEnergy) return '\0';
+        if (colPower > rowPower * thresholds.maxNormalTwist) return '\0';
+        if (rowPower > colPower * thresholds.maxReverseTwist) return '\0';
+
+        // Speech and music carry harmonics, DTMF does not. A row's second harmonic can
+        // land on the column tone's lobe in short frames; it is only checked when clear.
+        int colHarmonic = static_cast<int>(2.0 * colHz / binHz + 0.5);
+        if (colHarmonic + lobe < size / 2 && lobePower(colHarmonic) > colPower * thresholds.maxHarmonicRatio) return '\0';
+        int rowHarmonic = static_cast<int>(2.0 * rowHz / binHz + 0.5);
+        if (std::abs(rowHarmonic - col) > 2 * lobe && lobePower(rowHarmonic) > rowPower * thresholds.maxHarmonicRatio) {
+            return '\0';
+        }
+        return symbol;
+    }
+
+    // Refined row and column peak frequencies (Hz) of the last frame
+    std::pair<int, int> strongestFrequencies() const {
+        return std::make_pair(rowHz, colHz);
+    }
+
+    int getFrameSize() const {
+        return fft.getSize();
+    }
+
+private:
+    // First bin at or above (round = 1) or last bin at or below (round = 0) a frequency
+    int binAt(double hz, int round) const {
+        int bin = static_cast<int>(hz / binHz);
+        if (round && bin * binHz < hz) ++bin;
+        if (bin < 1) bin = 1;
+        if (bin > fft.getSize() / 2 - 1) bin = fft.getSize() / 2 - 1;
+        return bin;
+    }
+
+    int peakBin(int first, int last) const {
+        int best = first;
+        double bestPower = fft.binPower(first);
+        for (int k = first + 1; k <= last; ++k) {
+            double p = fft.binPower(k);
+            if (p > bestPower) {
+                best = k;
+                bestPower = p;
+            }
+        }
+        return best;
+    }
+
+    // Jacobsen: Re[(X[k-1] - X[k+1]) / (2X[k] - X[k-1] - X[k+1])] in bins, scaled for
+    // the window (exact for rectangular and Hann, within 0.001 bin for Blackman-Harris).
+    // Re(a / b) = Re(a * conj(b)) / |b|^2.
+    double peakOffset(int k) const {
+        const fftw_complex* bins = fft.spectrum();
+        double aRe = bins[k - 1][0] - bins[k + 1][0], aIm = bins[k - 1][1] - bins[k + 1][1];
+        double bRe = 2 * bins[k][0] - bins[k - 1][0] - bins[k + 1][0];
+        double bIm = 2 * bins[k][1] - bins[k - 1][1] - bins[k + 1][1];
+        double norm = bRe * bRe + bIm * bIm;
+        if (norm <= 0.0) return 0.0;
+        double offset = correction * (aRe * bRe + aIm * bIm) / norm;
+        return offset < -0.5 ? -0.5 : offset > 0.5 ? 0.5 : offset;
+    }
+
+    double lobePower(int k) const {
+        int first = k - lobe < 1 ? 1 : k - lobe;
+        int last = k + lobe > fft.getSize() / 2 - 1 ? fft.getSize() / 2 - 1 : k + lobe;
+        double sum = 0.0;
+        for (int i = first; i <= last; ++i) sum += fft.binPower(i);
+        return sum;
+    }
+
+    FFTWorkspace fft;
+    GoertzelThresholds thresholds;
+    double binHz;
+    int lobe;
+    double correction;
+    int rowBins[2];
+    int colBins[2];
+    int rowHz;
+    int colHz;
+};
+
+#endif
@@ -0,0 +1,124 @@
+#ifndef FFTWORKSPACE_HPP
+#define FFTWORKSPACE_HPP
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <fftw3.h>
+#include "kernels.hpp"
+
+// Analysis windows, tabulated once per workspace (periodic form, for spectral analysis)
+enum FFTWindow {
+    WINDOW_RECTANGULAR,    // No window: what the plain transform has always used
+    WINDOW_HANN,           // -31 dB sidelobes, main lobe +-2 bins
+    WINDOW_BLACKMAN_HARRIS // 4-term, -92 dB sidelobes, main lobe +-4 bins
+};
+
+// Owns the FFTW buffers and plan for one transform size.
+// Everything is allocated and planned once in the constructor, so transform()
+// never touches the heap. Plans are made with FFTW_MEASURE by default; pass a
+// wisdom file to keep that cost out of every startup but the first.
+class FFTWorkspace {
+public:
+    FFTWorkspace(int size, const std::string& wisdomFile = "", unsigned flags = FFTW_MEASURE)
+        : size(size), windowType(WINDOW_RECTANGULAR), magnitudes(size / 2) {
+        if (!wisdomFile.empty()) fftw_import_wisdom_from_filename(wisdomFile.c_str());
+
+        in = fftw_alloc_real(size);
+        out = fftw_alloc_complex(size / 2 + 1);
+
+        // Planning with FFTW_MEASURE scribbles over the buffers, so do it before they hold data
+        plan = fftw_plan_dft_r2c_1d(size, in, out, flags);
+
+        // Save after every plan, not only when there was no file: several sizes share one
+        // wisdom file, and the one planned now may be new to it
+        if (!wisdomFile.empty()) fftw_export_wisdom_to_filename(wisdomFile.c_str());
+    }
+
+    ~FFTWorkspace() {
+        fftw_destroy_plan(plan);
+        fftw_free(in);
+        fftw_free(out);
+    }
+
+    // Window applied by every transform from now on
+    void setWindow(FFTWindow type) {
+        windowType = type;
+        window.clear();
+        if (type == WINDOW_RECTANGULAR) return;
+
+        const double pi = 3.14159265358979323846;
+        window.resize(size);
+        for (int i = 0; i < size; ++i) {
+            double x = 2 * pi * i / size;
+            window[i] = type == WINDOW_HANN ? 0.5 - 0.5 * cos(x)
+                                            : 0.35875 - 0.48829 * cos(x) + 0.14128 * cos(2 * x) - 0.01168 * cos(3 * x);
+        }
+    }
+
+    FFTWindow getWindow() const {
+        return windowType;
+    }
+
+    // Transform up to size samples (zero-padded) and return the magnitudes of the first size/2 bins
+    const std::vector<double>& transform(const std::int16_t* samples, std::size_t sampleCount) {
+        execute(samples, sampleCount);
+        spectrumKernels().power(out[0], size / 2, magnitudes.data());
+        for (int i = 0; i < size / 2; ++i) magnitudes[i] = sqrt(magnitudes[i]); // sqrt(re^2 + im^2)
+        return magnitudes;
+    }
+
+    // Same as transform() but squared magnitudes: peaks and ratios come out the same
+    // without a sqrt per bin
+    const std::vector<double>& power(const std::int16_t* samples, std::size_t sampleCount) {
+        execute(samples, sampleCount);
+        spectrumKernels().power(out[0], size / 2, magnitudes.data());
+        return magnitudes;
+    }
+
+    // Window and transform, leaving the bins in spectrum(). Returns the energy of the
+    // windowed frame (sum of squares), which the bins hold size times over (Parseval).
+    double execute(const std::int16_t* samples, std::size_t sampleCount) {
+        std::size_t count = sampleCount < static_cast<std::size_t>(size) ? sampleCount : size;
+        double energy = 0.0;
+        if (window.empty()) {
+            for (std::size_t i = 0; i < count; ++i) in[i] = samples[i];
+        } else {
+            for (std::size_t i = 0; i < count; ++i) in[i] = samples[i] * window[i];
+        }
+        for (std::size_t i = 0; i < count; ++i) energy += in[i] * in[i];
+        for (int i = static_cast<int>(count); i < size; ++i) in[i] = 0.0;
+
+        fftw_execute(plan);
+        return energy;
+    }
+
+    // Bins 0..size/2 of the last transform
+    const fftw_complex* spectrum() const {
+        return out;
+    }
+
+    double binPower(int bin) const {
+        return out[bin][0] * out[bin][0] + out[bin][1] * out[bin][1];
+    }
+
+    int getSize() const {
+        return size;
+    }
+
+private:
+    FFTWorkspace(const FFTWorkspace&);
+    FFTWorkspace& operator=(const FFTWorkspace&);
+
+    int size;
+    double* in;
+    fftw_complex* out;
+    fftw_plan plan;
+    FFTWindow windowType;
+    std::vector<double> window; // Empty for rectangular
+    std::vector<double> magnitudes;
+};
+
+#endif
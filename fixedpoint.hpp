@@ -0,0 +1,203 @@
+#ifndef FIXEDPOINT_HPP
+#define FIXEDPOINT_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include "dtmf.hpp"
+#include "goertzel.hpp"
+#include "kernels.hpp"
+
+// Integer-only DTMF detection for receivers without a (fast) FPU.
+// Samples stay int16, filter states are int32 and powers and energies int64, with
+// one 32x32->64 multiply per tone and sample. Coefficients are cos(w) in Q30:
+// Q15 is fine at 8 kHz, but at 44.1/48 kHz the tones sit close to DC where a Q15
+// step detunes a filter by over 1 Hz and decisions drift from the double path.
+// Thresholds are turned into Q16 ratios once, at construction; detect() does not
+// touch floating point at all.
+
+// GoertzelThresholds as Q16 fixed-point ratios
+struct FixedThresholds {
+    std::int64_t minToneEnergy;
+    std::int64_t minPeakRatio;
+    std::int64_t maxNormalTwist;
+    std::int64_t maxReverseTwist;
+    std::int64_t maxHarmonicRatio;
+
+    constexpr explicit FixedThresholds(const GoertzelThresholds& t)
+        : minToneEnergy(toQ16(t.minToneEnergy)), minPeakRatio(toQ16(t.minPeakRatio)),
+          maxNormalTwist(toQ16(t.maxNormalTwist)), maxReverseTwist(toQ16(t.maxReverseTwist)),
+          maxHarmonicRatio(toQ16(t.maxHarmonicRatio)) {}
+
+    static constexpr std::int64_t toQ16(double value) {
+        return static_cast<std::int64_t>(value * 65536.0 + 0.5);
+    }
+};
+
+// Q30 cos(w) for the 8 tones (harmonic 1) or their second harmonics (harmonic 2)
+template <int SampleRate>
+constexpr std::array<std::int32_t, 8> makeQ30Coefficients(int harmonic) {
+    std::array<std::int32_t, 8> coeff{};
+    for (int tone = 0; tone < 8; ++tone) {
+        double c = constexprCos(2 * 3.14159265358979323846 * harmonic * dtmfToneFrequency(tone) / SampleRate);
+        coeff[tone] = static_cast<std::int32_t>(c * 1073741824.0 + (c >= 0 ? 0.5 : -0.5));
+    }
+    return coeff;
+}
+
+// Same decisions as GoertzelKernel<SampleRate, FrameSize>, in integer arithmetic
+template <int SampleRate, int FrameSize>
+class GoertzelFixed {
+public:
+    static constexpr int sampleRate = SampleRate;
+    static constexpr int frameSize = FrameSize;
+
+    // Keeps the int32 states and the int64 power terms clear of overflow down to
+    // 697 Hz at 48 kHz
+    static_assert(FrameSize > 0 && FrameSize <= 2048, "GoertzelFixed supports frames of up to 2048 samples");
+
+    // minRms is the energy gate: quieter frames are rejected before the filter bank runs
+    explicit GoertzelFixed(GoertzelThresholds thresholds = GoertzelThresholds(), int minRms = 0)
+        : thresholds(thresholds),
+          minEnergy(static_cast<std::int64_t>(minRms) * minRms * FrameSize),
+          lastEnergy(0), lastFreqs(0, 0) {
+        // Off-bin twist limits, in Q16 like the rest
+        TwistLimits twist = makeTwistLimits(thresholds, SampleRate, FrameSize);
+        for (int k = 0; k < 4; ++k) {
+            normalTwist[k] = FixedThresholds::toQ16(twist.normal[k]);
+            reverseTwist[k] = FixedThresholds::toQ16(twist.reverse[k]);
+        }
+    }
+
+    // Analyse exactly FrameSize samples
+    char detect(const std::int16_t* frame) {
+        NullDetectProbe probe;
+        return detect(frame, probe);
+    }
+
+    // Same, calling probe.mark() between the stages (not for gated frames)
+    template <typename Probe>
+    char detect(const std::int16_t* frame, Probe& probe) {
+        std::int32_t s1[8] = {0}, s2[8] = {0};
+        std::int64_t energy = spectrumKernels().energy(frame, FrameSize);
+        lastEnergy = energy;
+        lastFreqs = std::make_pair(0, 0);
+        if (energy < minEnergy || energy == 0) return '\0';
+
+        for (int n = 0; n < FrameSize; ++n) {
+            std::int32_t x = frame[n];
+            for (int k = 0; k < 8; ++k) {
+                std::int32_t s0 = x + twice(coeff[k], s1[k]) - s2[k];
+                s2[k] = s1[k];
+                s1[k] = s0;
+            }
+        }
+
+        std::int64_t power[8];
+        for (int k = 0; k < 8; ++k) power[k] = finalPower(coeff[k], s1[k], s2[k]);
+        probe.mark(DETECT_TRANSFORM);
+
+        int row = strongest(power), col = strongest(power + 4);
+        lastFreqs = std::make_pair(DTMF_ROW_FREQS[row], DTMF_COL_FREQS[col]);
+        probe.mark(DETECT_PEAK);
+
+        char symbol = match(frame, power, energy >> SHIFT, row, col);
+        probe.mark(DETECT_MATCH);
+        return symbol;
+    }
+
+    // Strongest row and column tone of the last analysed block (Hz); zeros if it was gated
+    std::pair<int, int> strongestFrequencies() const {
+        return lastFreqs;
+    }
+
+    // Sum of squares of the last frame
+    std::int64_t getEnergy() const {
+        return lastEnergy;
+    }
+
+private:
+    static constexpr int bits(long value) {
+        return value > 0 ? 1 + bits(value / 2) : 0;
+    }
+
+    // Powers are bounded by (FrameSize * 2^15)^2; shift them down to 40 bits so a
+    // product with a Q16 ratio (up to 2^23) stays inside int64
+    static constexpr int SHIFT = 2 * bits(FrameSize) + 30 > 40 ? 2 * bits(FrameSize) + 30 - 40 : 0;
+
+    static constexpr std::array<std::int32_t, 8> coeff = makeQ30Coefficients<SampleRate>(1);
+    static constexpr std::array<std::int32_t, 8> harmonicCoeff = makeQ30Coefficients<SampleRate>(2);
+
+    // 2cos(w) * s, rounded (c is cos(w) in Q30)
+    static std::int32_t twice(std::int32_t c, std::int32_t s) {
+        return static_cast<std::int32_t>((static_cast<std::int64_t>(c) * s + (1 << 28)) >> 29);
+    }
+
+    static std::int64_t finalPower(std::int32_t c, std::int32_t s1, std::int32_t s2) {
+        std::int64_t p = static_cast<std::int64_t>(s1) * s1 + static_cast<std::int64_t>(s2) * s2 -
+                         static_cast<std::int64_t>(twice(c, s1)) * s2;
+        return p > 0 ? p >> SHIFT : 0;
+    }
+
+    static std::int64_t harmonicPower(const std::int16_t* frame, std::int32_t c) {
+        std::int32_t s1 = 0, s2 = 0;
+        for (int n = 0; n < FrameSize; ++n) {
+            std::int32_t s0 = frame[n] + twice(c, s1) - s2;
+            s2 = s1;
+            s1 = s0;
+        }
+        return finalPower(c, s1, s2);
+    }
+
+    static int strongest(const std::int64_t* power) {
+        int best = 0;
+        for (int k = 1; k < 4; ++k) {
+            if (power[k] > power[best]) best = k;
+        }
+        return best;
+    }
+
+    char match(const std::int16_t* frame, const std::int64_t* power, std::int64_t energy, int row, int col) const {
+        if (!candidate(power, energy, row, col)) return '\0';
+
+        // Speech and music carry harmonics, DTMF does not
+        if (harmonicPower(frame, harmonicCoeff[row]) * 65536 > power[row] * thresholds.maxHarmonicRatio) return '\0';
+        if (harmonicPower(frame, harmonicCoeff[4 + col]) * 65536 > power[4 + col] * thresholds.maxHarmonicRatio) return '\0';
+
+        return DTMF_SYMBOLS[row][col];
+    }
+
+    // dtmfCandidate with every ratio test cross-multiplied
+    bool candidate(const std::int64_t* power, std::int64_t energy, int row, int col) const {
+        std::int64_t rowPower = power[row];
+        std::int64_t colPower = power[4 + col];
+
+        // 2 (Pr + Pc) / (N E) >= minToneEnergy
+        if (2 * (rowPower + colPower) * 65536 < thresholds.minToneEnergy * FrameSize * energy) return false;
+
+        if (colPower * 65536 > rowPower * normalTwist[row]) return false;
+        if (rowPower * 65536 > colPower * reverseTwist[col]) return false;
+
+        for (int k = 0; k < 4; ++k) {
+            if (k != row && power[k] * thresholds.minPeakRatio > rowPower * 65536) return false;
+            if (k != col && power[4 + k] * thresholds.minPeakRatio > colPower * 65536) return false;
+        }
+        return true;
+    }
+
+    FixedThresholds thresholds;
+    std::int64_t normalTwist[4];  // TwistLimits in Q16
+    std::int64_t reverseTwist[4];
+    std::int64_t minEnergy;
+    std::int64_t lastEnergy;
+    std::pair<int, int> lastFreqs;
+};
+
+// Standard configurations (~25 ms frames)
+typedef GoertzelFixed<8000, 205> GoertzelFixed8k;
+typedef GoertzelFixed<16000, 410> GoertzelFixed16k;
+typedef GoertzelFixed<44100, 1130> GoertzelFixed44k;
+typedef GoertzelFixed<48000, 1230> GoertzelFixed48k;
+
+#endif
@@ -0,0 +1,271 @@
+#ifndef GOERTZEL_HPP
+#define GOERTZEL_HPP
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include "dtmf.hpp"
+
+// Decision thresholds (all ratios are power ratios)
+struct GoertzelThresholds {
+    double minToneEnergy = 0.4;    // Share of block energy carried by the row + column tones
+    double minPeakRatio = 4.0;     // Strongest tone over runner-up in its group (~6 dB)
+    double maxNormalTwist = 6.3;   // Column over row (~8 dB)
+    double maxReverseTwist = 2.5;  // Row over column (~4 dB)
+    double maxHarmonicRatio = 0.25; // Second harmonic over fundamental (talk-off rejection)
+};
+
+const double DTMF_MAX_OFFSET = 0.015;     // Frequency error a receiver must accept (+-1.5 %)
+const double MIN_OFF_BIN_RESPONSE = 0.1; // Floor for bins so narrow the offset reaches a null
+
+// Power a Goertzel filter at freq over sampleCount samples keeps for a tone up to
+// DTMF_MAX_OFFSET away (1 on the bin). Longer blocks have narrower bins: at 8 kHz a
+// 205-sample block keeps only 0.22 of a 1633 Hz tone that is 1.5 % high.
+inline double offBinResponse(int freq, int sampleRate, std::size_t sampleCount) {
+    double x = 3.14159265358979323846 * DTMF_MAX_OFFSET * freq / sampleRate;
+    double n = static_cast<double>(sampleCount);
+    if (n * x >= 3.14159265358979323846) return MIN_OFF_BIN_RESPONSE;
+    double r = std::sin(n * x) / (n * std::sin(x));
+    return r * r > MIN_OFF_BIN_RESPONSE ? r * r : MIN_OFF_BIN_RESPONSE;
+}
+
+// Twist limits for one block length: the spec limits in GoertzelThresholds widened by
+// what the weaker tone may lose to its bin, so in-spec tones are not taken for twisted
+struct TwistLimits {
+    double normal[4];  // Column over row, by row
+    double reverse[4]; // Row over column, by column
+};
+
+inline TwistLimits makeTwistLimits(const GoertzelThresholds& thresholds, int sampleRate, std::size_t sampleCount) {
+    TwistLimits limits;
+    for (int k = 0; k < 4; ++k) {
+        limits.normal[k] = thresholds.maxNormalTwist / offBinResponse(DTMF_ROW_FREQS[k], sampleRate, sampleCount);
+        limits.reverse[k] = thresholds.maxReverseTwist / offBinResponse(DTMF_COL_FREQS[k], sampleRate, sampleCount);
+    }
+    return limits;
+}
+
+// Goertzel recurrence coefficient 2cos(2*pi*f/fs)
+inline double goertzelCoefficient(int freq, int sampleRate) {
+    return 2.0 * std::cos(2.0 * 3.14159265358979323846 * freq / sampleRate);
+}
+
+// Power of a single tone over a block
+inline double goertzelPower(const std::int16_t* samples, std::size_t sampleCount, double coeff) {
+    double s1 = 0.0, s2 = 0.0;
+    for (std::size_t n = 0; n < sampleCount; ++n) {
+        double s0 = samples[n] + coeff * s1 - s2;
+        s2 = s1;
+        s1 = s0;
+    }
+    return s1 * s1 + s2 * s2 - coeff * s1 * s2;
+}
+
+inline int strongestTone(const double* power) {
+    int best = 0;
+    for (int k = 1; k < 4; ++k) {
+        if (power[k] > power[best]) best = k;
+    }
+    return best;
+}
+
+// Strongest row (power[0..3]) and column (power[4..7])
+inline void dtmfStrongest(const double* power, int& row, int& col) {
+    row = strongestTone(power);
+    col = strongestTone(power + 4);
+}
+
+// Checks on the fundamentals for a given strongest row and column
+inline bool dtmfValid(const double* power, double energy, std::size_t sampleCount,
+                      const GoertzelThresholds& thresholds, const TwistLimits& twist, int row, int col) {
+    if (energy <= 0.0) return false;
+
+    double rowPower = power[row];
+    double colPower = power[4 + col];
+
+    // A pure tone of N samples yields a Goertzel power of N * energy / 2
+    double toneShare = 2.0 * (rowPower + colPower) / (static_cast<double>(sampleCount) * energy);
+    if (toneShare < thresholds.minToneEnergy) return false;
+
+    // Twist between the two groups
+    if (colPower > rowPower * twist.normal[row]) return false;
+    if (rowPower > colPower * twist.reverse[col]) return false;
+
+    // The winner in each group must clearly dominate the others
+    for (int k = 0; k < 4; ++k) {
+        if (k != row && power[k] * thresholds.minPeakRatio > rowPower) return false;
+        if (k != col && power[4 + k] * thresholds.minPeakRatio > colPower) return false;
+    }
+    return true;
+}
+
+// Checks on the fundamentals: power[0..3] are the rows, power[4..7] the columns.
+// Always reports the strongest row and column, returns true if they form a valid symbol.
+inline bool dtmfCandidate(const double* power, double energy, std::size_t sampleCount,
+                          const GoertzelThresholds& thresholds, const TwistLimits& twist, int& row, int& col) {
+    dtmfStrongest(power, row, col);
+    return dtmfValid(power, energy, sampleCount, thresholds, twist, row, col);
+}
+
+// Run the 8-tone bank over a block: fills power[0..7] and returns the block energy
+inline double goertzelBank(const std::int16_t* samples, std::size_t sampleCount, const double* coeff, double* power) {
+    double s1[8] = {0}, s2[8] = {0};
+    double energy = 0.0;
+    for (std::size_t n = 0; n < sampleCount; ++n) {
+        double x = samples[n];
+        energy += x * x;
+        for (int k = 0; k < 8; ++k) {
+            double s0 = x + coeff[k] * s1[k] - s2[k];
+            s2[k] = s1[k];
+            s1[k] = s0;
+        }
+    }
+    for (int k = 0; k < 8; ++k) {
+        power[k] = s1[k] * s1[k] + s2[k] * s2[k] - coeff[k] * s1[k] * s2[k];
+    }
+    return energy;
+}
+
+// Decision for a given strongest row and column: fundamentals, then their second harmonics.
+// harmonicCoeff is indexed like coeff (rows 0-3, columns 4-7).
+inline char goertzelMatch(const std::int16_t* samples, std::size_t sampleCount, const double* power, double energy,
+                          const double* harmonicCoeff, const GoertzelThresholds& thresholds, const TwistLimits& twist,
+                          int row, int col) {
+    if (!dtmfValid(power, energy, sampleCount, thresholds, twist, row, col)) return '\0';
+
+    // Speech and music carry harmonics, DTMF does not
+    if (goertzelPower(samples, sampleCount, harmonicCoeff[row]) > power[row] * thresholds.maxHarmonicRatio) return '\0';
+    if (goertzelPower(samples, sampleCount, harmonicCoeff[4 + col]) > power[4 + col] * thresholds.maxHarmonicRatio) return '\0';
+
+    return DTMF_SYMBOLS[row][col];
+}
+
+// Full decision on a block: peak search, then goertzelMatch
+inline char goertzelDecide(const std::int16_t* samples, std::size_t sampleCount, const double* power, double energy,
+                           const double* harmonicCoeff, const GoertzelThresholds& thresholds, const TwistLimits& twist,
+                           int& row, int& col) {
+    dtmfStrongest(power, row, col);
+    return goertzelMatch(samples, sampleCount, power, energy, harmonicCoeff, thresholds, twist, row, col);
+}
+
+// Points inside a frame detector's detect() where a probe is called: after the filter
+// bank, after the peak search and after the match. Used for per-stage timing.
+enum DetectStage { DETECT_TRANSFORM, DETECT_PEAK, DETECT_MATCH };
+
+// Probe that does nothing; detect(frame) uses it, so the hooks compile away
+struct NullDetectProbe {
+    void mark(DetectStage) {}
+};
+
+// Block Goertzel filter bank tuned to the 8 DTMF tones.
+// Replaces the full-spectrum FFT: only the tones we care about are evaluated,
+// and second harmonics are only computed for the winning row and column.
+class GoertzelDetector {
+public:
+    explicit GoertzelDetector(int sampleRate, GoertzelThresholds thresholds = GoertzelThresholds())
+        : sampleRate(sampleRate), thresholds(thresholds), twistSamples(0), lastFreqs(0, 0) {
+        for (int tone = 0; tone < 8; ++tone) {
+            coeff[tone] = goertzelCoefficient(dtmfToneFrequency(tone), sampleRate);
+            harmonicCoeff[tone] = goertzelCoefficient(2 * dtmfToneFrequency(tone), sampleRate);
+        }
+    }
+
+    // Analyse one block and return the DTMF symbol, or '\0' if none is present
+    char detect(const std::int16_t* samples, std::size_t sampleCount) {
+        lastFreqs = std::make_pair(0, 0);
+        if (sampleCount == 0) return '\0';
+
+        // Twist limits depend on the block length; recomputed only when it changes
+        if (sampleCount != twistSamples) {
+            twist = makeTwistLimits(thresholds, sampleRate, sampleCount);
+            twistSamples = sampleCount;
+        }
+
+        double power[8];
+        double energy = goertzelBank(samples, sampleCount, coeff, power);
+
+        int row, col;
+        char symbol = goertzelDecide(samples, sampleCount, power, energy, harmonicCoeff, thresholds, twist, row, col);
+        lastFreqs = std::make_pair(DTMF_ROW_FREQS[row], DTMF_COL_FREQS[col]);
+        return symbol;
+    }
+
+    // Strongest row and column tone of the last analysed block (Hz)
+    std::pair<int, int> strongestFrequencies() const {
+        return lastFreqs;
+    }
+
+    int getSampleRate() const {
+        return sampleRate;
+    }
+
+    const GoertzelThresholds& getThresholds() const {
+        return thresholds;
+    }
+
+private:
+    int sampleRate;
+    GoertzelThresholds thresholds;
+    TwistLimits twist;
+    std::size_t twistSamples;
+    double coeff[8];
+    double harmonicCoeff[8];
+    std::pair<int, int> lastFreqs;
+};
+
+// Same detector specialised at compile time for one sample rate and frame size:
+// coefficients come from the constexpr tables in dtmf.hpp and the frame length is
+// a constant, so the compiler can unroll the bank.
+template <int SampleRate, int FrameSize>
+class GoertzelKernel {
+public:
+    static constexpr int sampleRate = SampleRate;
+    static constexpr int frameSize = FrameSize;
+
+    explicit GoertzelKernel(GoertzelThresholds thresholds = GoertzelThresholds())
+        : thresholds(thresholds), twist(makeTwistLimits(thresholds, SampleRate, FrameSize)), lastFreqs(0, 0) {}
+
+    // Analyse exactly FrameSize samples
+    char detect(const std::int16_t* frame) {
+        NullDetectProbe probe;
+        return detect(frame, probe);
+    }
+
+    // Same, calling probe.mark() between the stages
+    template <typename Probe>
+    char detect(const std::int16_t* frame, Probe& probe) {
+        const double* coeff = DTMFCoefficients<SampleRate>::goertzel.data();
+        const double* harmonicCoeff = DTMFCoefficients<SampleRate>::goertzelHarmonic.data();
+
+        double power[8];
+        double energy = goertzelBank(frame, FrameSize, coeff, power);
+        probe.mark(DETECT_TRANSFORM);
+
+        int row, col;
+        dtmfStrongest(power, row, col);
+        lastFreqs = std::make_pair(DTMF_ROW_FREQS[row], DTMF_COL_FREQS[col]);
+        probe.mark(DETECT_PEAK);
+
+        char symbol = goertzelMatch(frame, FrameSize, power, energy, harmonicCoeff, thresholds, twist, row, col);
+        probe.mark(DETECT_MATCH);
+        return symbol;
+    }
+
+    std::pair<int, int> strongestFrequencies() const {
+        return lastFreqs;
+    }
+
+private:
+    GoertzelThresholds thresholds;
+    TwistLimits twist;
+    std::pair<int, int> lastFreqs;
+};
+
+// Standard configurations (~25 ms frames)
+typedef GoertzelKernel<8000, 205> GoertzelKernel8k;
+typedef GoertzelKernel<16000, 410> GoertzelKernel16k;
+typedef GoertzelKernel<44100, 1130> GoertzelKernel44k;
+typedef GoertzelKernel<48000, 1230> GoertzelKernel48k;
+
+#endif
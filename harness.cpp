@@ -0,0 +1,389 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <random>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include "goertzel.hpp"
+#include "slidingdft.hpp"
+#include "decimator.hpp"
+#include "receiver.hpp"
+#include "kernels.hpp"
+
+const double PI = 3.14159265358979323846;
+const int AMPLITUDE = 20000;        // Peak of row + column tone
+const int TONES_PER_RUN = 200;      // Tones sent per condition
+const double LEAD_IN = 0.2;         // Seconds of noise before the first tone
+const double IDLE_SECONDS = 60.0;   // Length of the noise-only run
+
+// One point of the sweep. Every axis is varied on its own around the baseline.
+struct Condition {
+    std::string axis;
+    double value;
+    double snrDb;    // Tone power over noise power; infinite means no noise
+    double offset;   // Frequency error of both tones (%)
+    double twistDb;  // Column over row level
+    double toneMs;
+    double gapMs;
+    bool idle;       // Noise only: every detection is a false trigger
+    bool inSpec;     // Counted against the reliability bar
+};
+
+// A receiver configuration, at the 8 kHz detect rate
+struct DetectorConfig {
+    std::string name;
+    bool sliding;
+    int frameSize;   // Block size, or sliding window
+    int hop;         // Block mode: samples between frames
+    int minTone;     // Sliding mode: samples a decision must hold
+    int minRms;      // Block mode loudness gate
+};
+
+// Transmitted tones, in capture samples
+struct SentTone {
+    std::size_t start;
+    std::size_t end;
+    char symbol;
+};
+
+// Detections, in capture samples (the sample at which the decision was available)
+struct Detection {
+    std::size_t time;
+    char symbol;
+};
+
+struct Result {
+    std::size_t tones = 0;
+    std::size_t missed = 0;
+    std::size_t falseTriggers = 0;
+    double audioSeconds = 0.0;
+    double cpuSeconds = 0.0;
+    std::vector<double> latencyMs;
+};
+
+struct Bar {
+    double maxMissPercent = 1.0;
+    double maxFalsePerMinute = 1.0;
+    double maxP99Ms = 60.0;
+};
+
+double cpuTime() {
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+double percentile(std::vector<double> values, double p) {
+    if (values.empty()) return NAN;
+    std::sort(values.begin(), values.end());
+    std::size_t index = static_cast<std::size_t>(p * (values.size() - 1) + 0.5);
+    return values[index];
+}
+
+std::vector<Condition> makeConditions() {
+    const Condition baseline = {"baseline", 0, 20.0, 0.0, 0.0, 50.0, 50.0, false, true};
+    std::vector<Condition> conditions;
+    conditions.push_back(baseline);
+
+    const double snrs[] = {30, 15, 10, 6, 3};
+    for (double v : snrs) {
+        Condition c = baseline;
+        c.axis = "snr_db"; c.value = v; c.snrDb = v; c.inSpec = v >= 10;
+        conditions.push_back(c);
+    }
+    // DTMF transmitters must hold +-1.5 %; receivers should reject beyond +-3.5 %
+    const double offsets[] = {-3.5, -2.5, -1.5, 1.5, 2.5, 3.5};
+    for (double v : offsets) {
+        Condition c = baseline;
+        c.axis = "offset_pct"; c.value = v; c.offset = v; c.inSpec = std::fabs(v) <= 1.5;
+        conditions.push_back(c);
+    }
+    // Positive twist: column tone louder. The detector rejects beyond 8 dB normal and
+    // 4 dB reverse twist, so the range held to the bar stops short of those edges.
+    const double twists[] = {-6, -4, -3, 3, 6, 8, 10};
+    for (double v : twists) {
+        Condition c = baseline;
+        c.axis = "twist_db"; c.value = v; c.twistDb = v; c.inSpec = v >= -3 && v <= 6;
+        conditions.push_back(c);
+    }
+    // Tones of 40 ms and more must be detected; 20 ms is the classic reject limit
+    const double tones[] = {20, 30, 40, 70, 100};
+    for (double v : tones) {
+        Condition c = baseline;
+        c.axis = "tone_ms"; c.value = v; c.toneMs = v; c.inSpec = v >= 40;
+        conditions.push_back(c);
+    }
+    const double gaps[] = {20, 30, 40, 100};
+    for (double v : gaps) {
+        Condition c = baseline;
+        c.axis = "gap_ms"; c.value = v; c.gapMs = v; c.inSpec = v >= 40;
+        conditions.push_back(c);
+    }
+    Condition idle = baseline;
+    idle.axis = "idle"; idle.idle = true;
+    conditions.push_back(idle);
+    return conditions;
+}
+
+// Synthesise the transmitted signal for one condition at the capture rate
+std::vector<std::int16_t> makeSignal(const Condition& condition, int sampleRate, std::vector<SentTone>& sent) {
+    std::mt19937 rng(7);
+    std::normal_distribution<double> gaussian(0.0, 1.0);
+
+    double columnShare = std::pow(10.0, condition.twistDb / 20.0);
+    double rowAmplitude = AMPLITUDE / (1.0 + columnShare);
+    double columnAmplitude = AMPLITUDE - rowAmplitude;
+    // Noise is set against the nominal (untwisted) tone pair so twist does not change it,
+    // and over the 4 kHz band the detector sees so the capture rate does not either
+    double signalPower = 2 * (AMPLITUDE / 2.0) * (AMPLITUDE / 2.0) / 2;
+    double bandNoise = signalPower / std::pow(10.0, condition.snrDb / 10.0);
+    double noise = std::isinf(condition.snrDb) ? 0.0 : std::sqrt(bandNoise * sampleRate / RECEIVER_DETECT_RATE);
+
+    std::size_t toneSamples = static_cast<std::size_t>(condition.toneMs * sampleRate / 1000);
+    std::size_t gapSamples = static_cast<std::size_t>(condition.gapMs * sampleRate / 1000);
+    std::size_t leadIn = static_cast<std::size_t>(LEAD_IN * sampleRate);
+    std::size_t total = condition.idle ? static_cast<std::size_t>(IDLE_SECONDS * sampleRate)
+                                       : leadIn + TONES_PER_RUN * (toneSamples + gapSamples);
+
+    std::vector<double> signal(total, 0.0);
+    sent.clear();
+    if (!condition.idle) {
+        double scale = 1.0 + condition.offset / 100.0;
+        for (int n = 0; n < TONES_PER_RUN; ++n) {
+            int row = rng() % 4, col = rng() % 4;
+            SentTone tone = {leadIn + n * (toneSamples + gapSamples), 0, DTMF_SYMBOLS[row][col]};
+            tone.end = tone.start + toneSamples;
+            double wRow = 2 * PI * DTMF_ROW_FREQS[row] * scale / sampleRate;
+            double wCol = 2 * PI * DTMF_COL_FREQS[col] * scale / sampleRate;
+            for (std::size_t i = 0; i < toneSamples; ++i) {
+                signal[tone.start + i] = rowAmplitude * std::sin(wRow * i) + columnAmplitude * std::sin(wCol * i);
+            }
+            sent.push_back(tone);
+        }
+    }
+
+    std::vector<std::int16_t> samples(total);
+    for (std::size_t i = 0; i < total; ++i) {
+        double x = signal[i] + noise * gaussian(rng);
+        samples[i] = static_cast<std::int16_t>(std::max(-32768.0, std::min(32767.0, x)));
+    }
+    return samples;
+}
+
+// Run one receiver configuration over decimated audio. ratio converts detect-rate
+// sample positions back to capture samples.
+std::vector<Detection> runDetector(const DetectorConfig& config, const std::vector<std::int16_t>& input, double ratio) {
+    std::vector<Detection> detections;
+    if (config.sliding) {
+        SlidingDFTDetector detector(RECEIVER_DETECT_RATE, config.frameSize, config.minTone);
+        for (std::size_t i = 0; i < input.size(); ++i) {
+            char symbol = detector.push(input[i]);
+            if (symbol != '\0') detections.push_back({static_cast<std::size_t>((i + 1) * ratio), symbol});
+        }
+        return detections;
+    }
+
+    // Frame decisions go through the receiver's debouncer, so the numbers describe
+    // what DTMF5 reports rather than every flicker of the raw detector
+    GoertzelDetector detector(RECEIVER_DETECT_RATE);
+    ToneDebouncer debouncer(RECEIVER_ON_FRAMES, RECEIVER_OFF_FRAMES);
+    std::int64_t gate = static_cast<std::int64_t>(config.minRms) * config.minRms * config.frameSize;
+    for (std::size_t start = 0; start + config.frameSize <= input.size(); start += config.hop) {
+        const std::int16_t* frame = &input[start];
+        std::int64_t energy = spectrumKernels().energy(frame, config.frameSize);
+        char symbol = energy < gate ? '\0' : detector.detect(frame, config.frameSize);
+        if (debouncer.update(symbol) != '\0') {
+            detections.push_back({static_cast<std::size_t>((start + config.frameSize) * ratio), symbol});
+        }
+    }
+    return detections;
+}
+
+// Match detections to sent tones: a detection belongs to the last tone that started
+// before it. The first matching detection of a tone is a hit; anything else is false.
+void score(const std::vector<SentTone>& sent, const std::vector<Detection>& detections, int sampleRate, Result& result) {
+    std::vector<bool> hit(sent.size(), false);
+    std::size_t next = 0;
+    for (const Detection& d : detections) {
+        while (next < sent.size() && sent[next].start <= d.time) ++next;
+        if (next == 0) {
+            ++result.falseTriggers;
+            continue;
+        }
+        std::size_t tone = next - 1;
+        if (hit[tone] || sent[tone].symbol != d.symbol) {
+            ++result.falseTriggers;
+            continue;
+        }
+        hit[tone] = true;
+        result.latencyMs.push_back(1000.0 * (d.time - sent[tone].start) / sampleRate);
+    }
+    result.tones += sent.size();
+    result.missed += std::count(hit.begin(), hit.end(), false);
+}
+
+// "block:N:hop[:minRms]" or "sliding:N[:minTone]", sizes at 8 kHz
+bool parseConfig(const std::string& text, DetectorConfig& config) {
+    std::vector<int> numbers;
+    std::stringstream stream(text);
+    std::string kind, item;
+    std::getline(stream, kind, ':');
+    while (std::getline(stream, item, ':')) numbers.push_back(std::atoi(item.c_str()));
+
+    config.name = text;
+    config.sliding = kind == "sliding";
+    config.minRms = RECEIVER_MIN_RMS;
+    config.minTone = RECEIVER_MIN_TONE;
+    if (numbers.empty() || numbers[0] <= 0 || (kind != "block" && kind != "sliding")) return false;
+    config.frameSize = numbers[0];
+    if (config.sliding) {
+        config.hop = 1;
+        if (numbers.size() > 1) config.minTone = numbers[1];
+        return config.minTone > 0;
+    }
+    if (numbers.size() < 2 || numbers[1] <= 0) return false;
+    config.hop = numbers[1];
+    if (numbers.size() > 2) config.minRms = numbers[2];
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    int sampleRate = 44100;
+    Bar bar;
+    const char* csvPath = nullptr;
+    std::vector<std::string> configText = {"block:102:51", "block:128:64", "block:160:80", "block:205:102",
+                                           "sliding:128:40", "sliding:205:80"};
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--rate") == 0 && i + 1 < argc) sampleRate = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--configs") == 0 && i + 1 < argc) {
+            configText.clear();
+            std::stringstream stream(argv[++i]);
+            std::string item;
+            while (std::getline(stream, item, ',')) configText.push_back(item);
+        }
+        else if (std::strcmp(argv[i], "--max-miss") == 0 && i + 1 < argc) bar.maxMissPercent = std::atof(argv[++i]);
+        else if (std::strcmp(argv[i], "--max-false") == 0 && i + 1 < argc) bar.maxFalsePerMinute = std::atof(argv[++i]);
+        else if (std::strcmp(argv[i], "--max-p99") == 0 && i + 1 < argc) bar.maxP99Ms = std::atof(argv[++i]);
+        else if (std::strcmp(argv[i], "--csv") == 0 && i + 1 < argc) csvPath = argv[++i];
+        else {
+            std::cerr << "Usage: harness [--rate HZ] [--configs block:N:hop[:minRms],sliding:N[:minTone],...]\n"
+                      << "               [--max-miss PCT] [--max-false PER_MIN] [--max-p99 MS] [--csv FILE]\n";
+            return -1;
+        }
+    }
+
+    std::vector<DetectorConfig> configs;
+    for (const std::string& text : configText) {
+        DetectorConfig config;
+        if (!parseConfig(text, config)) {
+            std::cerr << "Bad configuration '" << text << "'\n";
+            return -1;
+        }
+        configs.push_back(config);
+    }
+    if (sampleRate < RECEIVER_DETECT_RATE) {
+        std::cerr << "Sample rate must be at least " << RECEIVER_DETECT_RATE << " Hz\n";
+        return -1;
+    }
+
+    std::ofstream csv;
+    if (csvPath) {
+        csv.open(csvPath);
+        csv << "config,axis,value,in_spec,tones,miss_pct,false_per_min,p50_ms,p99_ms,cpu_ms_per_s\n";
+    }
+
+    std::vector<Condition> conditions = makeConditions();
+    std::vector<Result> totals(configs.size());
+    std::vector<bool> meetsBar(configs.size(), true);
+    double ratio = static_cast<double>(sampleRate) / RECEIVER_DETECT_RATE;
+
+    std::cout << "config            axis        value  tones  miss%  false/min  p50 ms  p99 ms  CPU ms/s\n";
+    for (const Condition& condition : conditions) {
+        std::vector<SentTone> sent;
+        std::vector<std::int16_t> signal = makeSignal(condition, sampleRate, sent);
+        double audioSeconds = static_cast<double>(signal.size()) / sampleRate;
+
+        // Decimation is shared by every configuration, so it is timed once
+        std::vector<std::int16_t> decimated;
+        double decimateCpu = 0.0;
+        if (sampleRate != RECEIVER_DETECT_RATE) {
+            Decimator decimator(sampleRate, RECEIVER_DETECT_RATE);
+            decimated.resize(decimator.outputCapacity(signal.size()));
+            double begin = cpuTime();
+            decimated.resize(decimator.process(signal.data(), signal.size(), decimated.data()));
+            decimateCpu = cpuTime() - begin;
+        } else {
+            decimated = signal;
+        }
+
+        for (std::size_t c = 0; c < configs.size(); ++c) {
+            double begin = cpuTime();
+            std::vector<Detection> detections = runDetector(configs[c], decimated, ratio);
+            double cpu = cpuTime() - begin + decimateCpu;
+
+            Result result;
+            result.audioSeconds = audioSeconds;
+            result.cpuSeconds = cpu;
+            score(sent, detections, sampleRate, result);
+
+            double missPercent = result.tones ? 100.0 * result.missed / result.tones : 0.0;
+            double falsePerMinute = result.falseTriggers * 60.0 / audioSeconds;
+            double p50 = percentile(result.latencyMs, 0.5), p99 = percentile(result.latencyMs, 0.99);
+            double cpuPerSecond = 1000.0 * cpu / audioSeconds;
+
+            if (condition.inSpec && (missPercent > bar.maxMissPercent || falsePerMinute > bar.maxFalsePerMinute ||
+                                     (result.tones && !(p99 <= bar.maxP99Ms)))) {
+                meetsBar[c] = false;
+            }
+            totals[c].audioSeconds += audioSeconds;
+            totals[c].cpuSeconds += cpu;
+
+            char line[160];
+            std::snprintf(line, sizeof(line), "%-16s  %-10s %6.1f%c %6zu %6.1f %10.2f %7.1f %7.1f %9.3f\n",
+                          configs[c].name.c_str(), condition.axis.c_str(), condition.value,
+                          condition.inSpec ? ' ' : '*', result.tones, missPercent, falsePerMinute, p50, p99,
+                          cpuPerSecond);
+            std::cout << line;
+            if (csv.is_open()) {
+                csv << configs[c].name << ',' << condition.axis << ',' << condition.value << ','
+                    << condition.inSpec << ',' << result.tones << ',' << missPercent << ',' << falsePerMinute
+                    << ',' << p50 << ',' << p99 << ',' << cpuPerSecond << '\n';
+            }
+        }
+    }
+    std::cout << "(* outside the spec range: reported, not held to the bar)\n\n";
+
+    // Cheapest configuration that holds the bar on every in-spec condition
+    int best = -1;
+    for (std::size_t c = 0; c < configs.size(); ++c) {
+        double cpuPerSecond = 1000.0 * totals[c].cpuSeconds / totals[c].audioSeconds;
+        std::cout << configs[c].name << ": " << cpuPerSecond << " CPU ms/s, "
+                  << (meetsBar[c] ? "meets" : "fails") << " the bar\n";
+        if (meetsBar[c] && (best < 0 || totals[c].cpuSeconds < totals[best].cpuSeconds)) best = static_cast<int>(c);
+    }
+    std::cout << "Bar: miss <= " << bar.maxMissPercent << " %, false triggers <= " << bar.maxFalsePerMinute
+              << " /min, p99 latency <= " << bar.maxP99Ms << " ms\n";
+
+    // The receiver's own block configuration must hold the bar, whatever is recommended
+    std::string shipped = "block:" + std::to_string(RECEIVER_FRAME) + ":" + std::to_string(RECEIVER_HOP);
+    bool shippedFails = false;
+    for (std::size_t c = 0; c < configs.size(); ++c) {
+        if (configs[c].name != shipped) continue;
+        std::cout << "Receiver default " << shipped << (meetsBar[c] ? " meets" : " fails") << " the bar\n";
+        shippedFails = !meetsBar[c];
+    }
+    if (best < 0) {
+        std::cout << "No configuration meets the bar\n";
+        return 1;
+    }
+    std::cout << "Recommended: " << configs[best].name << "\n";
+    return shippedFails ? 1 : 0;
+}
+
+// g++ harness.cpp -o harness -O2 -std=c++17
\ No newline at end of file
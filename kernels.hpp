@@ -0,0 +1,382 @@
+#ifndef KERNELS_HPP
+#define KERNELS_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define KERNELS_X86 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define KERNELS_NEON 1
+#endif
+
+// Instruction set a kernel is built for
+enum KernelType {
+    KERNEL_AUTO,
+    KERNEL_SCALAR,
+    KERNEL_SSE2,
+    KERNEL_AVX2,
+    KERNEL_NEON
+};
+
+inline bool kernelSupported(KernelType type) {
+    switch (type) {
+    case KERNEL_SCALAR: return true;
+#ifdef KERNELS_X86
+    case KERNEL_SSE2: __builtin_cpu_init(); return __builtin_cpu_supports("sse2");
+    case KERNEL_AVX2: __builtin_cpu_init(); return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+#ifdef KERNELS_NEON
+    case KERNEL_NEON: return true;
+#endif
+    default: return false;
+    }
+}
+
+// Pick the widest kernel the CPU supports, or fall back to scalar if the requested one is missing
+inline KernelType resolveKernel(KernelType requested) {
+    if (requested != KERNEL_AUTO) return kernelSupported(requested) ? requested : KERNEL_SCALAR;
+
+    const KernelType preference[] = {KERNEL_AVX2, KERNEL_SSE2, KERNEL_NEON};
+    for (KernelType type : preference) {
+        if (kernelSupported(type)) return type;
+    }
+    return KERNEL_SCALAR;
+}
+
+inline const char* kernelTypeName(KernelType type) {
+    switch (type) {
+    case KERNEL_SSE2: return "sse2";
+    case KERNEL_AVX2: return "avx2";
+    case KERNEL_NEON: return "neon";
+    default: return "scalar";
+    }
+}
+
+// Spectrum and loudness kernels. Each has a scalar reference that the SIMD versions
+// agree with: the energy is exact in integers, the power spectrum does the same two
+// multiplies and one add per bin (equal to the last bit unless the compiler fuses the
+// scalar one into an FMA), and the peak search breaks ties the same way.
+
+// Sum of squares of int16 samples. A square fits in int32 but two of them may not
+// (2 * 32768^2 = 2^31), so pairs are summed as unsigned 32-bit and widened to 64 bits.
+typedef std::int64_t (*EnergyKernel)(const std::int16_t* samples, std::size_t count);
+
+// power[i] = re^2 + im^2 for count interleaved (re, im) doubles, e.g. an fftw_complex array
+typedef void (*PowerKernel)(const double* bins, std::size_t count, double* power);
+
+// Indices of the largest and second-largest of power[first..last], the lower index
+// winning ties; peaks[1] is -1 when the range holds a single bin
+typedef void (*PeakKernel)(const double* power, int first, int last, int* peaks);
+
+inline std::int64_t energyKernelScalar(const std::int16_t* samples, std::size_t count) {
+    std::int64_t energy = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        std::int32_t x = samples[i];
+        energy += x * x;
+    }
+    return energy;
+}
+
+inline void powerKernelScalar(const double* bins, std::size_t count, double* power) {
+    for (std::size_t i = 0; i < count; ++i) {
+        power[i] = bins[2 * i] * bins[2 * i] + bins[2 * i + 1] * bins[2 * i + 1];
+    }
+}
+
+// Bins are visited in order and only a strictly larger value displaces a peak, so the
+// lower index wins ties
+inline void peakKernelScalar(const double* power, int first, int last, int* peaks) {
+    peaks[0] = first;
+    peaks[1] = -1;
+    for (int i = first + 1; i <= last; ++i) {
+        if (power[i] > power[peaks[0]]) {
+            peaks[1] = peaks[0];
+            peaks[0] = i;
+        } else if (peaks[1] < 0 || power[i] > power[peaks[1]]) {
+            peaks[1] = i;
+        }
+    }
+}
+
+// The SIMD searches avoid a running top two, whose compare-and-blend chain is serial,
+// and make short independent passes instead: the largest value, the first bin that
+// holds it, then the same either side of that bin for the runner-up.
+typedef double (*RangeMax)(const double* power, int first, int last);
+typedef int (*FirstEqual)(const double* power, int first, int last, double value);
+
+inline void peakSearch(RangeMax rangeMax, FirstEqual firstEqual, const double* power, int first, int last, int* peaks) {
+    int peak = firstEqual(power, first, last, rangeMax(power, first, last));
+    peaks[0] = peak;
+    peaks[1] = -1;
+    bool left = peak > first, right = peak < last;
+    if (!left && !right) return;
+
+    double leftMax = left ? rangeMax(power, first, peak - 1) : 0.0;
+    double rightMax = right ? rangeMax(power, peak + 1, last) : 0.0;
+    if (left && (!right || leftMax >= rightMax)) {
+        peaks[1] = firstEqual(power, first, peak - 1, leftMax);
+    } else {
+        peaks[1] = firstEqual(power, peak + 1, last, rightMax);
+    }
+}
+
+#ifdef KERNELS_X86
+// 8 samples per instruction
+__attribute__((target("sse2")))
+inline std::int64_t energyKernelSSE2(const std::int16_t* samples, std::size_t count) {
+    __m128i sum = _mm_setzero_si128(), zero = _mm_setzero_si128();
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(samples + i));
+        __m128i pairs = _mm_madd_epi16(x, x); // 4 unsigned 32-bit sums of two squares
+        sum = _mm_add_epi64(sum, _mm_unpacklo_epi32(pairs, zero));
+        sum = _mm_add_epi64(sum, _mm_unpackhi_epi32(pairs, zero));
+    }
+    std::int64_t lanes[2];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), sum);
+    return lanes[0] + lanes[1] + energyKernelScalar(samples + i, count - i);
+}
+
+// 2 bins per instruction
+__attribute__((target("sse2")))
+inline void powerKernelSSE2(const double* bins, std::size_t count, double* power) {
+    std::size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        __m128d a = _mm_loadu_pd(bins + 2 * i);     // re0 im0
+        __m128d b = _mm_loadu_pd(bins + 2 * i + 2); // re1 im1
+        a = _mm_mul_pd(a, a);
+        b = _mm_mul_pd(b, b);
+        _mm_storeu_pd(power + i, _mm_add_pd(_mm_unpacklo_pd(a, b), _mm_unpackhi_pd(a, b)));
+    }
+    powerKernelScalar(bins + 2 * i, count - i, power + i);
+}
+
+// Four independent maxima in flight to hide the latency
+__attribute__((target("sse2")))
+inline double rangeMaxSSE2(const double* power, int first, int last) {
+    int i = first;
+    double best = power[i];
+    if (last - first + 1 >= 8) {
+        __m128d m0 = _mm_loadu_pd(power + i), m1 = _mm_loadu_pd(power + i + 2);
+        __m128d m2 = _mm_loadu_pd(power + i + 4), m3 = _mm_loadu_pd(power + i + 6);
+        for (i += 8; i + 8 <= last + 1; i += 8) {
+            m0 = _mm_max_pd(m0, _mm_loadu_pd(power + i));
+            m1 = _mm_max_pd(m1, _mm_loadu_pd(power + i + 2));
+            m2 = _mm_max_pd(m2, _mm_loadu_pd(power + i + 4));
+            m3 = _mm_max_pd(m3, _mm_loadu_pd(power + i + 6));
+        }
+        double lanes[2];
+        _mm_storeu_pd(lanes, _mm_max_pd(_mm_max_pd(m0, m1), _mm_max_pd(m2, m3)));
+        best = lanes[0] > lanes[1] ? lanes[0] : lanes[1];
+    }
+    for (; i <= last; ++i) {
+        if (power[i] > best) best = power[i];
+    }
+    return best;
+}
+
+__attribute__((target("sse2")))
+inline int firstEqualSSE2(const double* power, int first, int last, double value) {
+    __m128d target = _mm_set1_pd(value);
+    int i = first;
+    for (; i + 2 <= last + 1; i += 2) {
+        int mask = _mm_movemask_pd(_mm_cmpeq_pd(_mm_loadu_pd(power + i), target));
+        if (mask) return i + __builtin_ctz(mask);
+    }
+    for (; i <= last; ++i) {
+        if (power[i] == value) return i;
+    }
+    return -1;
+}
+
+inline void peakKernelSSE2(const double* power, int first, int last, int* peaks) {
+    peakSearch(rangeMaxSSE2, firstEqualSSE2, power, first, last, peaks);
+}
+
+// 16 samples per instruction
+__attribute__((target("avx2")))
+inline std::int64_t energyKernelAVX2(const std::int16_t* samples, std::size_t count) {
+    __m256i sum = _mm256_setzero_si256();
+    std::size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(samples + i));
+        __m256i pairs = _mm256_madd_epi16(x, x);
+        sum = _mm256_add_epi64(sum, _mm256_cvtepu32_epi64(_mm256_castsi256_si128(pairs)));
+        sum = _mm256_add_epi64(sum, _mm256_cvtepu32_epi64(_mm256_extracti128_si256(pairs, 1)));
+    }
+    std::int64_t lanes[4];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), sum);
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3] + energyKernelScalar(samples + i, count - i);
+}
+
+// 4 bins per instruction. Built without FMA so the tail, which is the inlined scalar
+// loop, cannot be contracted and the rounding matches the reference.
+__attribute__((target("avx2")))
+inline void powerKernelAVX2(const double* bins, std::size_t count, double* power) {
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256d a = _mm256_loadu_pd(bins + 2 * i);     // re0 im0 re1 im1
+        __m256d b = _mm256_loadu_pd(bins + 2 * i + 4); // re2 im2 re3 im3
+        __m256d sums = _mm256_hadd_pd(_mm256_mul_pd(a, a), _mm256_mul_pd(b, b)); // p0 p2 p1 p3
+        _mm256_storeu_pd(power + i, _mm256_permute4x64_pd(sums, 0xd8));
+    }
+    powerKernelScalar(bins + 2 * i, count - i, power + i);
+}
+
+__attribute__((target("avx2")))
+inline double rangeMaxAVX2(const double* power, int first, int last) {
+    int i = first;
+    double best = power[i];
+    if (last - first + 1 >= 16) {
+        __m256d m0 = _mm256_loadu_pd(power + i), m1 = _mm256_loadu_pd(power + i + 4);
+        __m256d m2 = _mm256_loadu_pd(power + i + 8), m3 = _mm256_loadu_pd(power + i + 12);
+        for (i += 16; i + 16 <= last + 1; i += 16) {
+            m0 = _mm256_max_pd(m0, _mm256_loadu_pd(power + i));
+            m1 = _mm256_max_pd(m1, _mm256_loadu_pd(power + i + 4));
+            m2 = _mm256_max_pd(m2, _mm256_loadu_pd(power + i + 8));
+            m3 = _mm256_max_pd(m3, _mm256_loadu_pd(power + i + 12));
+        }
+        double lanes[4];
+        _mm256_storeu_pd(lanes, _mm256_max_pd(_mm256_max_pd(m0, m1), _mm256_max_pd(m2, m3)));
+        best = lanes[0];
+        for (int lane = 1; lane < 4; ++lane) {
+            if (lanes[lane] > best) best = lanes[lane];
+        }
+    }
+    for (; i <= last; ++i) {
+        if (power[i] > best) best = power[i];
+    }
+    return best;
+}
+
+__attribute__((target("avx2")))
+inline int firstEqualAVX2(const double* power, int first, int last, double value) {
+    __m256d target = _mm256_set1_pd(value);
+    int i = first;
+    for (; i + 4 <= last + 1; i += 4) {
+        int mask = _mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(power + i), target, _CMP_EQ_OQ));
+        if (mask) return i + __builtin_ctz(mask);
+    }
+    for (; i <= last; ++i) {
+        if (power[i] == value) return i;
+    }
+    return -1;
+}
+
+inline void peakKernelAVX2(const double* power, int first, int last, int* peaks) {
+    peakSearch(rangeMaxAVX2, firstEqualAVX2, power, first, last, peaks);
+}
+#endif
+
+#ifdef KERNELS_NEON
+// 8 samples per instruction pair: int32 squares, pairwise-added into 64-bit lanes
+inline std::int64_t energyKernelNEON(const std::int16_t* samples, std::size_t count) {
+    int64x2_t sum = vdupq_n_s64(0);
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        int16x8_t x = vld1q_s16(samples + i);
+        sum = vpadalq_s32(sum, vmull_s16(vget_low_s16(x), vget_low_s16(x)));
+        sum = vpadalq_s32(sum, vmull_s16(vget_high_s16(x), vget_high_s16(x)));
+    }
+    return vgetq_lane_s64(sum, 0) + vgetq_lane_s64(sum, 1) + energyKernelScalar(samples + i, count - i);
+}
+
+#ifdef __aarch64__
+// 2 bins per instruction (double-precision vectors are AArch64 only)
+inline void powerKernelNEON(const double* bins, std::size_t count, double* power) {
+    std::size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        float64x2x2_t v = vld2q_f64(bins + 2 * i); // re0 re1, im0 im1
+        vst1q_f64(power + i, vaddq_f64(vmulq_f64(v.val[0], v.val[0]), vmulq_f64(v.val[1], v.val[1])));
+    }
+    powerKernelScalar(bins + 2 * i, count - i, power + i);
+}
+
+inline double rangeMaxNEON(const double* power, int first, int last) {
+    int i = first;
+    double best = power[i];
+    if (last - first + 1 >= 8) {
+        float64x2_t m0 = vld1q_f64(power + i), m1 = vld1q_f64(power + i + 2);
+        float64x2_t m2 = vld1q_f64(power + i + 4), m3 = vld1q_f64(power + i + 6);
+        for (i += 8; i + 8 <= last + 1; i += 8) {
+            m0 = vmaxq_f64(m0, vld1q_f64(power + i));
+            m1 = vmaxq_f64(m1, vld1q_f64(power + i + 2));
+            m2 = vmaxq_f64(m2, vld1q_f64(power + i + 4));
+            m3 = vmaxq_f64(m3, vld1q_f64(power + i + 6));
+        }
+        best = vmaxvq_f64(vmaxq_f64(vmaxq_f64(m0, m1), vmaxq_f64(m2, m3)));
+    }
+    for (; i <= last; ++i) {
+        if (power[i] > best) best = power[i];
+    }
+    return best;
+}
+
+inline int firstEqualNEON(const double* power, int first, int last, double value) {
+    float64x2_t target = vdupq_n_f64(value);
+    int i = first;
+    for (; i + 2 <= last + 1; i += 2) {
+        uint64x2_t equal = vceqq_f64(vld1q_f64(power + i), target);
+        if (vgetq_lane_u64(equal, 0)) return i;
+        if (vgetq_lane_u64(equal, 1)) return i + 1;
+    }
+    for (; i <= last; ++i) {
+        if (power[i] == value) return i;
+    }
+    return -1;
+}
+
+inline void peakKernelNEON(const double* power, int first, int last, int* peaks) {
+    peakSearch(rangeMaxNEON, firstEqualNEON, power, first, last, peaks);
+}
+#endif
+#endif
+
+struct SpectrumKernels {
+    KernelType type;
+    EnergyKernel energy;
+    PowerKernel power;
+    PeakKernel peaks;
+};
+
+inline SpectrumKernels spectrumKernelsFor(KernelType type) {
+    type = resolveKernel(type);
+    SpectrumKernels kernels = {type, energyKernelScalar, powerKernelScalar, peakKernelScalar};
+    switch (type) {
+#ifdef KERNELS_X86
+    case KERNEL_SSE2:
+        kernels.energy = energyKernelSSE2;
+        kernels.power = powerKernelSSE2;
+        kernels.peaks = peakKernelSSE2;
+        break;
+    case KERNEL_AVX2:
+        kernels.energy = energyKernelAVX2;
+        kernels.power = powerKernelAVX2;
+        kernels.peaks = peakKernelAVX2;
+        break;
+#endif
+#ifdef KERNELS_NEON
+    case KERNEL_NEON:
+        kernels.energy = energyKernelNEON;
+#ifdef __aarch64__
+        kernels.power = powerKernelNEON;
+        kernels.peaks = peakKernelNEON;
+#endif
+        break;
+#endif
+    default:
+        break;
+    }
+    return kernels;
+}
+
+// The widest kernels this CPU runs, resolved on first use
+inline const SpectrumKernels& spectrumKernels() {
+    static const SpectrumKernels kernels = spectrumKernelsFor(KERNEL_AUTO);
+    return kernels;
+}
+
+#endif
@@ -0,0 +1,295 @@
+#ifndef MULTICHANNEL_HPP
+#define MULTICHANNEL_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "goertzel.hpp"
+#include "kernels.hpp"
+
+// Symbol onset on one channel
+struct SymbolEvent {
+    int channel;
+    char symbol;
+    std::uint64_t sampleIndex; // First sample of the block the symbol was detected in
+};
+
+// Goertzel bank over a block of channel-interleaved floats.
+// stage[n * stride + c] is sample n of channel c; stride is a multiple of 8.
+// Writes power[k * stride + c] for the 8 tones and energy[c].
+typedef void (*BankKernel)(const float* stage, std::size_t frames, std::size_t stride,
+                           const float* coeff, float* power, float* energy);
+
+inline void bankKernelScalar(const float* stage, std::size_t frames, std::size_t stride,
+                             const float* coeff, float* power, float* energy) {
+    for (std::size_t c = 0; c < stride; ++c) {
+        float s1[8] = {0}, s2[8] = {0};
+        float e = 0.0f;
+        for (std::size_t n = 0; n < frames; ++n) {
+            float x = stage[n * stride + c];
+            e += x * x;
+            for (int k = 0; k < 8; ++k) {
+                float s0 = x + coeff[k] * s1[k] - s2[k];
+                s2[k] = s1[k];
+                s1[k] = s0;
+            }
+        }
+        for (int k = 0; k < 8; ++k) {
+            power[k * stride + c] = s1[k] * s1[k] + s2[k] * s2[k] - coeff[k] * s1[k] * s2[k];
+        }
+        energy[c] = e;
+    }
+}
+
+#ifdef KERNELS_X86
+// 4 channels per instruction
+__attribute__((target("sse2")))
+inline void bankKernelSSE2(const float* stage, std::size_t frames, std::size_t stride,
+                           const float* coeff, float* power, float* energy) {
+    for (std::size_t c = 0; c < stride; c += 4) {
+        __m128 s1[8], s2[8], cf[8];
+        for (int k = 0; k < 8; ++k) {
+            s1[k] = _mm_setzero_ps();
+            s2[k] = _mm_setzero_ps();
+            cf[k] = _mm_set1_ps(coeff[k]);
+        }
+        __m128 e = _mm_setzero_ps();
+        for (std::size_t n = 0; n < frames; ++n) {
+            __m128 x = _mm_loadu_ps(stage + n * stride + c);
+            e = _mm_add_ps(e, _mm_mul_ps(x, x));
+            for (int k = 0; k < 8; ++k) {
+                __m128 s0 = _mm_sub_ps(_mm_add_ps(x, _mm_mul_ps(cf[k], s1[k])), s2[k]);
+                s2[k] = s1[k];
+                s1[k] = s0;
+            }
+        }
+        for (int k = 0; k < 8; ++k) {
+            __m128 p = _mm_add_ps(_mm_mul_ps(s1[k], s1[k]), _mm_mul_ps(s2[k], s2[k]));
+            p = _mm_sub_ps(p, _mm_mul_ps(cf[k], _mm_mul_ps(s1[k], s2[k])));
+            _mm_storeu_ps(power + k * stride + c, p);
+        }
+        _mm_storeu_ps(energy + c, e);
+    }
+}
+
+// 8 channels per instruction. The bank runs in two passes of 4 tones so the
+// recurrence state stays in the 16 ymm registers.
+__attribute__((target("avx2,fma")))
+inline void bankKernelAVX2(const float* stage, std::size_t frames, std::size_t stride,
+                           const float* coeff, float* power, float* energy) {
+    for (std::size_t c = 0; c < stride; c += 8) {
+        __m256 e = _mm256_setzero_ps();
+        for (int pass = 0; pass < 8; pass += 4) {
+            __m256 s1[4], s2[4], cf[4];
+            for (int k = 0; k < 4; ++k) {
+                s1[k] = _mm256_setzero_ps();
+                s2[k] = _mm256_setzero_ps();
+                cf[k] = _mm256_set1_ps(coeff[pass + k]);
+            }
+            for (std::size_t n = 0; n < frames; ++n) {
+                __m256 x = _mm256_loadu_ps(stage + n * stride + c);
+                if (pass == 0) e = _mm256_fmadd_ps(x, x, e);
+                for (int k = 0; k < 4; ++k) {
+                    __m256 s0 = _mm256_fmadd_ps(cf[k], s1[k], _mm256_sub_ps(x, s2[k]));
+                    s2[k] = s1[k];
+                    s1[k] = s0;
+                }
+            }
+            for (int k = 0; k < 4; ++k) {
+                __m256 p = _mm256_fmadd_ps(s1[k], s1[k], _mm256_mul_ps(s2[k], s2[k]));
+                p = _mm256_fnmadd_ps(cf[k], _mm256_mul_ps(s1[k], s2[k]), p);
+                _mm256_storeu_ps(power + (pass + k) * stride + c, p);
+            }
+        }
+        _mm256_storeu_ps(energy + c, e);
+    }
+}
+#endif
+
+#ifdef KERNELS_NEON
+// 4 channels per instruction
+inline void bankKernelNEON(const float* stage, std::size_t frames, std::size_t stride,
+                           const float* coeff, float* power, float* energy) {
+    for (std::size_t c = 0; c < stride; c += 4) {
+        float32x4_t s1[8], s2[8], cf[8];
+        for (int k = 0; k < 8; ++k) {
+            s1[k] = vdupq_n_f32(0.0f);
+            s2[k] = vdupq_n_f32(0.0f);
+            cf[k] = vdupq_n_f32(coeff[k]);
+        }
+        float32x4_t e = vdupq_n_f32(0.0f);
+        for (std::size_t n = 0; n < frames; ++n) {
+            float32x4_t x = vld1q_f32(stage + n * stride + c);
+            e = vmlaq_f32(e, x, x);
+            for (int k = 0; k < 8; ++k) {
+                float32x4_t s0 = vmlaq_f32(vsubq_f32(x, s2[k]), cf[k], s1[k]);
+                s2[k] = s1[k];
+                s1[k] = s0;
+            }
+        }
+        for (int k = 0; k < 8; ++k) {
+            float32x4_t p = vmlaq_f32(vmulq_f32(s2[k], s2[k]), s1[k], s1[k]);
+            p = vmlsq_f32(p, cf[k], vmulq_f32(s1[k], s2[k]));
+            vst1q_f32(power + k * stride + c, p);
+        }
+        vst1q_f32(energy + c, e);
+    }
+}
+#endif
+
+inline BankKernel bankKernelFor(KernelType type) {
+    switch (type) {
+#ifdef KERNELS_X86
+    case KERNEL_SSE2: return bankKernelSSE2;
+    case KERNEL_AVX2: return bankKernelAVX2;
+#endif
+#ifdef KERNELS_NEON
+    case KERNEL_NEON: return bankKernelNEON;
+#endif
+    default: return bankKernelScalar;
+    }
+}
+
+// Runs the DTMF Goertzel bank on many channels at once, one channel per SIMD lane.
+// All channels advance in lockstep; a decision is made every blockSize samples and
+// a SymbolEvent is emitted whenever a channel starts a new symbol.
+class MultiChannelDetector {
+public:
+    MultiChannelDetector(int sampleRate, int channels, int blockSize,
+                         GoertzelThresholds thresholds = GoertzelThresholds(),
+                         KernelType kernelType = KERNEL_AUTO)
+        : channels(channels), blockSize(blockSize), stride((channels + 7) / 8 * 8),
+          thresholds(thresholds), twist(makeTwistLimits(thresholds, sampleRate, blockSize)),
+          filled(0), blockStart(0),
+          stage(static_cast<std::size_t>(blockSize) * stride, 0.0f),
+          power(8 * stride), energy(stride), lastSymbol(channels, '\0'), candidate(channels, '\0'),
+          rowHarmonic(stride), colHarmonic(stride), rowLimit(stride), colLimit(stride),
+          rs1(stride), rs2(stride), cs1(stride), cs2(stride),
+          rowHarmonicPower(stride), colHarmonicPower(stride) {
+        kernelType = resolveKernel(kernelType);
+        kernel = bankKernelFor(kernelType);
+        kernelName = kernelTypeName(kernelType);
+        for (int i = 0; i < 4; ++i) {
+            coeff[i] = static_cast<float>(goertzelCoefficient(DTMF_ROW_FREQS[i], sampleRate));
+            coeff[i + 4] = static_cast<float>(goertzelCoefficient(DTMF_COL_FREQS[i], sampleRate));
+            rowHarmonicCoeff[i] = static_cast<float>(goertzelCoefficient(2 * DTMF_ROW_FREQS[i], sampleRate));
+            colHarmonicCoeff[i] = static_cast<float>(goertzelCoefficient(2 * DTMF_COL_FREQS[i], sampleRate));
+        }
+    }
+
+    // samples holds frames * channels values, channel-interleaved
+    void processInterleaved(const std::int16_t* samples, std::size_t frames, std::vector<SymbolEvent>& events) {
+        for (std::size_t f = 0; f < frames; ++f) {
+            float* row = &stage[filled * stride];
+            const std::int16_t* in = samples + f * channels;
+            for (int c = 0; c < channels; ++c) row[c] = in[c];
+            if (++filled == blockSize) runBlock(events);
+        }
+    }
+
+    // channelData[c] points to frames samples of channel c
+    void processPlanar(const std::int16_t* const* channelData, std::size_t frames, std::vector<SymbolEvent>& events) {
+        std::size_t done = 0;
+        while (done < frames) {
+            std::size_t count = std::min(frames - done, static_cast<std::size_t>(blockSize - filled));
+            for (int c = 0; c < channels; ++c) {
+                const std::int16_t* in = channelData[c] + done;
+                float* out = &stage[filled * stride + c];
+                for (std::size_t n = 0; n < count; ++n) out[n * stride] = in[n];
+            }
+            filled += static_cast<int>(count);
+            done += count;
+            if (filled == blockSize) runBlock(events);
+        }
+    }
+
+    const char* instructionSet() const {
+        return kernelName;
+    }
+
+    int getChannelCount() const {
+        return channels;
+    }
+
+private:
+    void runBlock(std::vector<SymbolEvent>& events) {
+        kernel(stage.data(), blockSize, stride, coeff, power.data(), energy.data());
+
+        // Fundamental checks; remember which harmonics each candidate needs
+        bool anyCandidate = false;
+        for (int c = 0; c < channels; ++c) {
+            double p[8];
+            for (int k = 0; k < 8; ++k) p[k] = power[k * stride + c];
+
+            int row, col;
+            candidate[c] = dtmfCandidate(p, energy[c], blockSize, thresholds, twist, row, col) ? DTMF_SYMBOLS[row][col] : '\0';
+            rowHarmonic[c] = rowHarmonicCoeff[row];
+            colHarmonic[c] = colHarmonicCoeff[col];
+            rowLimit[c] = static_cast<float>(p[row] * thresholds.maxHarmonicRatio);
+            colLimit[c] = static_cast<float>(p[4 + col] * thresholds.maxHarmonicRatio);
+            anyCandidate = anyCandidate || candidate[c] != '\0';
+        }
+        if (anyCandidate) harmonicPass();
+
+        for (int c = 0; c < channels; ++c) {
+            char symbol = candidate[c];
+            if (rowHarmonicPower[c] > rowLimit[c] || colHarmonicPower[c] > colLimit[c]) symbol = '\0';
+            if (symbol != '\0' && symbol != lastSymbol[c]) {
+                SymbolEvent event = {c, symbol, blockStart};
+                events.push_back(event);
+            }
+            lastSymbol[c] = symbol;
+        }
+
+        filled = 0;
+        blockStart += blockSize;
+    }
+
+    // Second harmonic of each channel's winning row and column. The coefficient
+    // differs per lane, so the loop runs across channels and vectorises as is.
+    void harmonicPass() {
+        std::fill(rs1.begin(), rs1.end(), 0.0f);
+        std::fill(rs2.begin(), rs2.end(), 0.0f);
+        std::fill(cs1.begin(), cs1.end(), 0.0f);
+        std::fill(cs2.begin(), cs2.end(), 0.0f);
+        for (int n = 0; n < blockSize; ++n) {
+            const float* x = &stage[n * stride];
+            for (std::size_t c = 0; c < stride; ++c) {
+                float r0 = x[c] + rowHarmonic[c] * rs1[c] - rs2[c];
+                rs2[c] = rs1[c];
+                rs1[c] = r0;
+                float c0 = x[c] + colHarmonic[c] * cs1[c] - cs2[c];
+                cs2[c] = cs1[c];
+                cs1[c] = c0;
+            }
+        }
+        for (std::size_t c = 0; c < stride; ++c) {
+            rowHarmonicPower[c] = rs1[c] * rs1[c] + rs2[c] * rs2[c] - rowHarmonic[c] * rs1[c] * rs2[c];
+            colHarmonicPower[c] = cs1[c] * cs1[c] + cs2[c] * cs2[c] - colHarmonic[c] * cs1[c] * cs2[c];
+        }
+    }
+
+    int channels;
+    int blockSize;
+    std::size_t stride;
+    GoertzelThresholds thresholds;
+    TwistLimits twist;
+    int filled;
+    std::uint64_t blockStart;
+    std::vector<float> stage;
+    std::vector<float> power;
+    std::vector<float> energy;
+    std::vector<char> lastSymbol;
+    std::vector<char> candidate;
+    std::vector<float> rowHarmonic, colHarmonic;           // Per-channel harmonic coefficients
+    std::vector<float> rowLimit, colLimit;                 // Largest acceptable harmonic power
+    std::vector<float> rs1, rs2, cs1, cs2;                 // Harmonic recurrence state
+    std::vector<float> rowHarmonicPower, colHarmonicPower;
+    float coeff[8];
+    float rowHarmonicCoeff[4], colHarmonicCoeff[4];
+    BankKernel kernel;
+    const char* kernelName;
+};
+
+#endif
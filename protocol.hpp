@@ -0,0 +1,290 @@
+#ifndef PROTOCOL_HPP
+#define PROTOCOL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <sstream>
+#include <string>
+
+// Robot command messages: "#" + command + checksum (decimal) + "*".
+// Shared by the transmitter (DTMF2) and the receivers that decode what arrives.
+
+// DTMF symbol sent for a message character: digits, '#' (start) and '*' (end) go
+// out as themselves, the robot commands are sent on digit keys
+constexpr char messageSymbol(char c) {
+    return c == 'F' ? '1'   // Forward
+         : c == 'B' ? '5'   // Back
+         : c == 'L' ? '9'   // Left
+         : c == 'R' ? '0'   // Right
+         : (c >= '0' && c <= '9') || c == '#' || c == '*' ? c
+         : '\0';
+}
+
+// Robot command sent on a DTMF symbol, or '\0'
+constexpr char symbolCommand(char symbol) {
+    return symbol == '1' ? 'F'
+         : symbol == '5' ? 'B'
+         : symbol == '9' ? 'L'
+         : symbol == '0' ? 'R'
+         : '\0';
+}
+
+// Compute checksum as the ASCII value of the command
+inline int computeChecksum(char command) {
+    return static_cast<int>(command);
+}
+
+// Convert checksum to DTMF-compatible string
+inline std::string encodeChecksum(int checksum) {
+    std::stringstream ss;
+    ss << checksum; // Convert checksum to string
+    return ss.str();
+}
+
+// Build the command message
+inline std::string buildMessage(char command) {
+    int checksum = computeChecksum(command);
+    std::string checksumStr = encodeChecksum(checksum); // Convert checksum to string
+    return "#" + std::string(1, command) + checksumStr + "*";
+}
+
+// The DTMF symbols a message goes out as; characters without one are left out
+inline std::string messageSymbols(const std::string& message) {
+    std::string symbols;
+    for (char c : message) {
+        char symbol = messageSymbol(c);
+        if (symbol != '\0') symbols += symbol;
+    }
+    return symbols;
+}
+
+// A message received in full
+struct ReceivedCommand {
+    char command;        // 'F', 'B', 'L' or 'R'
+    std::uint64_t start; // Sample time of the '#'
+    std::uint64_t end;   // Sample time of the '*'
+};
+
+// Incremental message decoder, fed one tone at a time as tones are recognised.
+// A command is emitted as soon as its '*' arrives with a matching checksum. State is
+// a single partial message, so history never builds up: '#' always starts a new
+// message (resynchronising after a lost tone), anything that cannot continue the
+// current message drops it, and so does a pause longer than maxGap samples.
+class CommandDecoder {
+public:
+    // Checksums are the decimal ASCII code: at most 3 digits
+    static const int MAX_CHECKSUM_DIGITS = 3;
+
+    explicit CommandDecoder(std::uint64_t maxGap = 0)
+        : maxGap(maxGap), state(WAIT_START), command('\0'), checksum(0), digits(0), start(0), last(0),
+          errors(0) {}
+
+    // Feed a tone and the sample time it was recognised at. Returns true if it
+    // completed a valid message, which is then stored in received.
+    bool push(char symbol, std::uint64_t time, ReceivedCommand& received) {
+        if (state != WAIT_START && maxGap > 0 && time - last > maxGap) fail();
+        last = time;
+
+        if (symbol == '#') {
+            if (state != WAIT_START) ++errors; // Previous message never finished
+            state = WAIT_COMMAND;
+            start = time;
+            return false;
+        }
+
+        switch (state) {
+        case WAIT_START:
+            return false; // Stray tone between messages
+        case WAIT_COMMAND:
+            command = symbolCommand(symbol);
+            if (command == '\0') return fail();
+            checksum = 0;
+            digits = 0;
+            state = CHECKSUM;
+            return false;
+        case CHECKSUM:
+            if (symbol >= '0' && symbol <= '9' && digits < MAX_CHECKSUM_DIGITS) {
+                checksum = checksum * 10 + (symbol - '0');
+                ++digits;
+                return false;
+            }
+            if (symbol != '*' || digits == 0 || checksum != computeChecksum(command)) return fail();
+            state = WAIT_START;
+            received.command = command;
+            received.start = start;
+            received.end = time;
+            return true;
+        }
+        return false;
+    }
+
+    // Messages dropped: bad checksum, unexpected tone, timeout or restarted by '#'
+    std::uint64_t getErrors() const {
+        return errors;
+    }
+
+private:
+    enum State { WAIT_START, WAIT_COMMAND, CHECKSUM };
+
+    bool fail() {
+        ++errors;
+        state = WAIT_START;
+        return false;
+    }
+
+    std::uint64_t maxGap;
+    State state;
+    char command;
+    int checksum;
+    int digits;
+    std::uint64_t start;
+    std::uint64_t last; // Time of the previous tone
+    std::uint64_t errors;
+};
+
+// High-rate link mode: short tones and all 16 symbols, each carrying a nibble.
+//
+//   Single command: [0] [command] [CRC-4 of the first two]            3 symbols
+//   Batch of n:     [n] [command] x n [CRC-8 of header and commands]  n + 3 symbols (n = 1..15)
+//
+// Commands are nibbles (F=0, B=1, L=2, R=3). The CRCs run over the nibbles MSB first.
+// Any single wrong symbol is a burst of at most 4 bits, which both CRCs always catch.
+// Frames are separated by a pause longer than any gap inside a frame, so a receiver
+// that lost or gained a tone is back in step at the next frame.
+const int LINK_TONE_MS = 40;        // Tone length
+const int LINK_GAP_MS = 30;         // Silence between the tones of a frame
+const int LINK_FRAME_GAP_MS = 100;  // Silence between frames
+const int LINK_MAX_GAP_MS = 105;    // Receiver: onsets further apart than this start a new frame
+const int LINK_MAX_BATCH = 15;
+const char LINK_COMMANDS[] = "FBLR";
+
+// Symbol for a nibble: '0'-'9', 'A'-'D', '*', '#' carry 0-15
+constexpr char linkSymbol(int nibble) {
+    return nibble < 10 ? static_cast<char>('0' + nibble) : "ABCD*#"[nibble - 10];
+}
+
+// Nibble for a symbol, or -1
+constexpr int linkNibble(char symbol) {
+    return symbol >= '0' && symbol <= '9' ? symbol - '0'
+         : symbol >= 'A' && symbol <= 'D' ? symbol - 'A' + 10
+         : symbol == '*' ? 14
+         : symbol == '#' ? 15
+         : -1;
+}
+
+// Command code for a robot command, or -1
+inline int linkCommandCode(char command) {
+    for (int code = 0; LINK_COMMANDS[code] != '\0'; ++code) {
+        if (LINK_COMMANDS[code] == command) return code;
+    }
+    return -1;
+}
+
+// CRC of width bits (4 or 8) over nibbles, MSB first, zero initial value.
+// CRC-4 uses x^4 + x + 1 (0x3), CRC-8 uses x^8 + x^2 + x + 1 (0x07).
+inline int linkCrc(const int* nibbles, std::size_t count, int width, int poly) {
+    int top = 1 << (width - 1), mask = (1 << width) - 1, crc = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        for (int bit = 3; bit >= 0; --bit) {
+            bool feedback = ((crc & top) != 0) != (((nibbles[i] >> bit) & 1) != 0);
+            crc = (crc << 1) & mask;
+            if (feedback) crc ^= poly;
+        }
+    }
+    return crc;
+}
+
+// Symbols for one link frame: a single command, or a batch of up to LINK_MAX_BATCH.
+// Empty if a command is unknown or there are too many.
+inline std::string buildLinkFrame(const std::string& commands) {
+    if (commands.empty() || commands.size() > static_cast<std::size_t>(LINK_MAX_BATCH)) return "";
+    int nibbles[LINK_MAX_BATCH + 3];
+    std::size_t count = 0;
+    nibbles[count++] = commands.size() == 1 ? 0 : static_cast<int>(commands.size());
+    for (char command : commands) {
+        int code = linkCommandCode(command);
+        if (code < 0) return "";
+        nibbles[count++] = code;
+    }
+    if (commands.size() == 1) {
+        nibbles[count] = linkCrc(nibbles, count, 4, 0x3);
+        ++count;
+    } else {
+        int crc = linkCrc(nibbles, count, 8, 0x07);
+        nibbles[count++] = crc >> 4;
+        nibbles[count++] = crc & 0xF;
+    }
+
+    std::string symbols;
+    for (std::size_t i = 0; i < count; ++i) symbols += linkSymbol(nibbles[i]);
+    return symbols;
+}
+
+// A link frame received in full
+struct LinkFrame {
+    std::string commands;
+    std::uint64_t start; // Sample time of the first tone
+    std::uint64_t end;   // Sample time of the last tone
+};
+
+// Incremental link decoder, fed one tone at a time like CommandDecoder. The frame
+// length is known from the header, so a frame is emitted on its last tone; a pause
+// of more than maxGap samples between tones abandons a partial frame.
+class LinkDecoder {
+public:
+    explicit LinkDecoder(std::uint64_t maxGap) : maxGap(maxGap), count(0), expected(0), start(0), last(0), errors(0) {}
+
+    // Feed a tone and the sample time it was recognised at. Returns true if it
+    // completed a frame with a valid CRC, which is then stored in frame.
+    bool push(char symbol, std::uint64_t time, LinkFrame& frame) {
+        if (count > 0 && time - last > maxGap) {
+            ++errors; // Frame cut short
+            count = 0;
+        }
+        last = time;
+
+        int nibble = linkNibble(symbol);
+        if (nibble < 0) return false;
+        if (count == 0) {
+            start = time;
+            expected = nibble == 0 ? 3 : nibble + 3;
+        }
+        nibbles[count++] = nibble;
+        if (count < expected) return false;
+
+        bool single = nibbles[0] == 0;
+        std::size_t commands = single ? 1 : nibbles[0];
+        bool valid = single ? linkCrc(nibbles, 2, 4, 0x3) == nibbles[2]
+                            : linkCrc(nibbles, commands + 1, 8, 0x07) == (nibbles[count - 2] << 4 | nibbles[count - 1]);
+        for (std::size_t i = 1; valid && i <= commands; ++i) {
+            valid = nibbles[i] < static_cast<int>(sizeof(LINK_COMMANDS)) - 1;
+        }
+        count = 0;
+        if (!valid) {
+            ++errors;
+            return false;
+        }
+
+        frame.commands.clear();
+        for (std::size_t i = 1; i <= commands; ++i) frame.commands += LINK_COMMANDS[nibbles[i]];
+        frame.start = start;
+        frame.end = time;
+        return true;
+    }
+
+    // Frames dropped: bad CRC, unknown command or cut short
+    std::uint64_t getErrors() const {
+        return errors;
+    }
+
+private:
+    std::uint64_t maxGap;
+    int nibbles[LINK_MAX_BATCH + 3];
+    std::size_t count;
+    std::size_t expected;
+    std::uint64_t start;
+    std::uint64_t last;
+    std::uint64_t errors;
+};
+
+#endif
@@ -0,0 +1,238 @@
+#ifndef RECEIVER_HPP
+#define RECEIVER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "goertzel.hpp"
+#include "slidingdft.hpp"
+#include "fixedpoint.hpp"
+#include "ringbuffer.hpp"
+#include "decimator.hpp"
+#include "telemetry.hpp"
+#include "kernels.hpp"
+
+const int RECEIVER_DETECT_RATE = 8000; // Rate the detector runs at after decimation
+const int RECEIVER_FRAME = 205;        // Goertzel block size at the detect rate (~26 ms, ~39 Hz bandwidth)
+const int RECEIVER_HOP = 102;          // Samples (at the detect rate) between consecutive analysis frames
+const int RECEIVER_MIN_RMS = 1000;     // Frames quieter than this are not analysed
+const int RECEIVER_MIN_TONE = 80;      // Sliding mode: samples (at the detect rate) a decision must hold (10 ms)
+const int RECEIVER_CHUNK = 1024;       // Capture samples pulled from the source at a time
+const int RECEIVER_ON_FRAMES = 2;      // Block mode: frames a symbol must hold before it counts as a tone
+const int RECEIVER_OFF_FRAMES = 2;     // Block mode: frames without it before the tone is over
+
+// Build with -DDTMF_FIXED_POINT to run the integer-only frame detector
+#ifdef DTMF_FIXED_POINT
+typedef GoertzelFixed<RECEIVER_DETECT_RATE, RECEIVER_FRAME> ReceiverFrameDetector;
+#else
+typedef GoertzelKernel<RECEIVER_DETECT_RATE, RECEIVER_FRAME> ReceiverFrameDetector;
+#endif
+
+// What the receiver concluded about one analysis frame (or, in sliding mode, one tone onset)
+struct ReceiverFrame {
+    char symbol;                  // '\0' if no tone
+    bool onset;                   // symbol is a new tone (not the continuation of the previous frame's)
+    bool quiet;                   // Below the loudness gate, not analysed
+    std::int64_t energy;          // Sum of squares over the frame
+    std::size_t frameSize;
+    std::pair<int, int> strongest; // Strongest row and column (Hz) when analysed
+    std::uint64_t sampleIndex;    // Capture sample at the end of the frame the decision was made on
+};
+
+// Tone-on/tone-off hysteresis over per-frame decisions. A tone starts once the same
+// symbol has been seen in onFrames consecutive frames and ends after offFrames frames
+// without it, so a single-frame dropout or glitch neither splits a tone into two
+// nor invents one.
+class ToneDebouncer {
+public:
+    ToneDebouncer(int onFrames, int offFrames)
+        : onFrames(onFrames), offFrames(offFrames), candidate('\0'), held(0), missed(0), active('\0') {}
+
+    // Feed one frame's decision ('\0' for none). Returns the symbol on the frame where
+    // its tone starts, else '\0'.
+    char update(char symbol) {
+        if (active != '\0') {
+            if (symbol == active) {
+                missed = 0;
+                return '\0';
+            }
+            if (++missed < offFrames) return '\0';
+            active = '\0';
+            missed = 0;
+        }
+
+        held = symbol != '\0' && symbol == candidate ? held + 1 : 1;
+        candidate = symbol;
+        if (symbol == '\0' || held < onFrames) return '\0';
+        active = symbol;
+        held = 0;
+        return symbol;
+    }
+
+    // Tone currently on ('\0' between tones)
+    char current() const {
+        return active;
+    }
+
+private:
+    int onFrames;
+    int offFrames;
+    char candidate; // Symbol of the current run of frames
+    int held;       // Length of that run
+    int missed;     // Frames since the active tone was last seen
+    char active;
+};
+
+// Whether a receiver runs the sliding detector: on request, and always for link frames,
+// whose 30 ms gaps are too short for block mode to keep repeated symbols apart
+inline bool receiverSliding(bool sliding, bool link) {
+    return sliding || link;
+}
+
+// DTMF5's receive chain, independent of where the audio comes from: decimate the
+// capture rate down to 8 kHz, cut overlapping frames, gate on loudness, run the
+// frame detector on them and debounce the decisions - or, in sliding mode, update
+// the per-sample detector (which debounces itself).
+// Works with any source that has read(int16*, count).
+class DTMFReceiver {
+public:
+    explicit DTMFReceiver(int captureRate, int hop = RECEIVER_HOP, bool sliding = false)
+        : captureRate(captureRate), sliding(sliding),
+          slidingDetector(RECEIVER_DETECT_RATE, RECEIVER_FRAME, RECEIVER_MIN_TONE),
+          decimator(captureRate, RECEIVER_DETECT_RATE), decimate(captureRate != RECEIVER_DETECT_RATE),
+          input(RECEIVER_CHUNK), decimated(decimator.outputCapacity(RECEIVER_CHUNK)),
+          frames(RECEIVER_FRAME, hop), debouncer(RECEIVER_ON_FRAMES, RECEIVER_OFF_FRAMES), consumed(0),
+          detected(0), telemetry(nullptr) {
+        decimator.reserve(RECEIVER_CHUNK);
+    }
+
+    // Process everything the source has ready. handler(const ReceiverFrame&) is called
+    // for every analysed frame (block mode) or every tone onset (sliding mode).
+    // Returns the number of capture samples read.
+    template <typename Source, typename Handler>
+    std::size_t poll(Source& source, Handler&& handler) {
+        std::size_t total = 0, got;
+        while ((got = source.read(input.data(), input.size())) > 0) {
+            total += got;
+            consumed += got;
+            if (telemetry) {
+                TelemetryProbe probe(*telemetry);
+                runChunk(got, handler, probe);
+            } else {
+                NullTelemetryProbe probe;
+                runChunk(got, handler, probe);
+            }
+        }
+        return total;
+    }
+
+    // Record stage timings, frame levels and symbols into telemetry (nullptr to stop)
+    void setTelemetry(Telemetry* target) {
+        telemetry = target;
+    }
+
+    int getCaptureRate() const {
+        return captureRate;
+    }
+
+    // Capture samples consumed so far
+    std::uint64_t getSampleCount() const {
+        return consumed;
+    }
+
+private:
+    // Decimated samples handed to the frame assembler
+    struct Span {
+        const std::int16_t* data;
+        std::size_t count;
+
+        std::size_t read(std::int16_t* out, std::size_t n) {
+            if (n > count) n = count;
+            for (std::size_t i = 0; i < n; ++i) out[i] = data[i];
+            data += n;
+            count -= n;
+            return n;
+        }
+    };
+
+    template <typename Handler, typename Probe>
+    void runChunk(std::size_t got, Handler& handler, Probe& probe) {
+        const std::int16_t* samples = input.data();
+        std::size_t count = got;
+        if (decimate) {
+            count = decimator.process(input.data(), got, decimated.data());
+            samples = decimated.data();
+            probe.mark(STAGE_DECIMATE);
+        }
+        if (sliding) {
+            runSliding(samples, count, handler, probe);
+        } else {
+            runFrames(samples, count, handler, probe);
+        }
+        detected += count;
+    }
+
+    // Capture sample matching a position in the detect-rate stream
+    std::uint64_t captureIndex(std::uint64_t detectIndex) const {
+        return decimate ? detectIndex * captureRate / RECEIVER_DETECT_RATE : detectIndex;
+    }
+
+    template <typename Handler, typename Probe>
+    void runSliding(const std::int16_t* samples, std::size_t count, Handler& handler, Probe& probe) {
+        probe.start();
+        for (std::size_t i = 0; i < count; ++i) {
+            char symbol = slidingDetector.push(samples[i]);
+            if (symbol == '\0') continue;
+            probe.onset(symbol);
+            ReceiverFrame result = {symbol, true, false, 0, static_cast<std::size_t>(RECEIVER_FRAME),
+                                    std::make_pair(0, 0), captureIndex(detected + i + 1)};
+            handler(result);
+        }
+        probe.mark(STAGE_SLIDING);
+    }
+
+    template <typename Handler, typename Probe>
+    void runFrames(const std::int16_t* samples, std::size_t count, Handler& handler, Probe& probe) {
+        Span span = {samples, count};
+        while (frames.next(span)) {
+            const std::int16_t* frame = frames.frame();
+            ReceiverFrame result = {'\0', false, false, 0, frames.frameSize(), std::make_pair(0, 0),
+                                    captureIndex(detected + count - span.count)};
+            probe.start();
+
+            // Loudness gate in integers: sum of squares against MIN_RMS^2 per sample
+            result.energy = spectrumKernels().energy(frame, frames.frameSize());
+            bool quiet = result.energy < static_cast<std::int64_t>(RECEIVER_MIN_RMS) * RECEIVER_MIN_RMS *
+                                             static_cast<std::int64_t>(frames.frameSize());
+            probe.mark(STAGE_GATE);
+            if (quiet) {
+                result.quiet = true;
+            } else {
+                result.symbol = detector.detect(frame, probe);
+                result.strongest = detector.strongestFrequencies();
+            }
+
+            // Frames overlap and decisions flicker at tone edges; report each tone once
+            result.onset = debouncer.update(result.symbol) != '\0';
+            probe.frame(result.energy, result.frameSize, result.quiet, result.symbol, result.onset);
+            handler(result);
+        }
+    }
+
+    int captureRate;
+    bool sliding;
+    ReceiverFrameDetector detector;
+    SlidingDFTDetector slidingDetector;
+    Decimator decimator;
+    bool decimate;
+    std::vector<std::int16_t> input;
+    std::vector<std::int16_t> decimated;
+    FrameAssembler<std::int16_t> frames;
+    ToneDebouncer debouncer;
+    std::uint64_t consumed;
+    std::uint64_t detected; // Samples at the detect rate before the current chunk
+    Telemetry* telemetry;
+};
+
+#endif
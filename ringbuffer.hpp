@@ -0,0 +1,131 @@
+#ifndef RINGBUFFER_HPP
+#define RINGBUFFER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+// Single-producer/single-consumer lock-free ring buffer for trivially copyable samples.
+// One thread may call write(), one other thread may call read(); neither ever blocks.
+// Capacity is rounded up to a power of two.
+template <typename T>
+class SpscRingBuffer {
+public:
+    explicit SpscRingBuffer(std::size_t minCapacity) : head(0), tail(0) {
+        std::size_t capacity = 1;
+        while (capacity < minCapacity) capacity <<= 1;
+        buffer.resize(capacity);
+        mask = capacity - 1;
+    }
+
+    // Producer side. Copies as much as fits and returns the number of items written.
+    std::size_t write(const T* data, std::size_t count) {
+        std::size_t h = head.load(std::memory_order_relaxed);
+        std::size_t t = tail.load(std::memory_order_acquire);
+        std::size_t space = buffer.size() - (h - t);
+        if (count > space) count = space;
+
+        copyIn(h, data, count);
+        head.store(h + count, std::memory_order_release);
+        return count;
+    }
+
+    // Consumer side. Copies up to count items and returns the number read.
+    std::size_t read(T* data, std::size_t count) {
+        std::size_t t = tail.load(std::memory_order_relaxed);
+        std::size_t h = head.load(std::memory_order_acquire);
+        std::size_t available = h - t;
+        if (count > available) count = available;
+
+        copyOut(t, data, count);
+        tail.store(t + count, std::memory_order_release);
+        return count;
+    }
+
+    // Consumer side. Drops up to count items without copying them.
+    std::size_t skip(std::size_t count) {
+        std::size_t t = tail.load(std::memory_order_relaxed);
+        std::size_t available = head.load(std::memory_order_acquire) - t;
+        if (count > available) count = available;
+        tail.store(t + count, std::memory_order_release);
+        return count;
+    }
+
+    // Items waiting to be read (exact on the consumer side, a lower bound elsewhere)
+    std::size_t size() const {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+
+    std::size_t capacity() const {
+        return buffer.size();
+    }
+
+private:
+    void copyIn(std::size_t position, const T* data, std::size_t count) {
+        std::size_t start = position & mask;
+        std::size_t first = count < buffer.size() - start ? count : buffer.size() - start;
+        std::memcpy(&buffer[start], data, first * sizeof(T));
+        std::memcpy(&buffer[0], data + first, (count - first) * sizeof(T));
+    }
+
+    void copyOut(std::size_t position, T* data, std::size_t count) const {
+        std::size_t start = position & mask;
+        std::size_t first = count < buffer.size() - start ? count : buffer.size() - start;
+        std::memcpy(data, &buffer[start], first * sizeof(T));
+        std::memcpy(data + first, &buffer[0], (count - first) * sizeof(T));
+    }
+
+    std::vector<T> buffer;
+    std::size_t mask;
+    alignas(64) std::atomic<std::size_t> head; // Next slot to write, only advanced by the producer
+    alignas(64) std::atomic<std::size_t> tail; // Next slot to read, only advanced by the consumer
+};
+
+// Cuts a sample stream into fixed-size analysis frames that advance by hop samples.
+// With hop < frameSize consecutive frames overlap; every input sample is analysed.
+// hop must not exceed frameSize.
+template <typename T>
+class FrameAssembler {
+public:
+    FrameAssembler(std::size_t frameSize, std::size_t hop)
+        : window(frameSize), hop(hop), filled(0), ready(false) {}
+
+    // Pull from any source with read(T*, count); returns true when frame() holds a new frame
+    template <typename Source>
+    bool next(Source& source) {
+        if (ready) {
+            // Slide the window: keep the overlap, drop the oldest hop samples
+            // (nothing to keep when hop == frameSize: frames are back to back)
+            std::size_t keep = window.size() > hop ? window.size() - hop : 0;
+            if (keep > 0) std::memmove(window.data(), window.data() + window.size() - keep, keep * sizeof(T));
+            filled = keep;
+            ready = false;
+        }
+        if (filled < window.size()) {
+            filled += source.read(&window[filled], window.size() - filled);
+        }
+        ready = filled == window.size();
+        return ready;
+    }
+
+    const T* frame() const {
+        return window.data();
+    }
+
+    std::size_t frameSize() const {
+        return window.size();
+    }
+
+    std::size_t hopSize() const {
+        return hop;
+    }
+
+private:
+    std::vector<T> window;
+    std::size_t hop;
+    std::size_t filled;
+    bool ready;
+};
+
+#endif
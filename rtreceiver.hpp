@@ -0,0 +1,239 @@
+#ifndef RTRECEIVER_HPP
+#define RTRECEIVER_HPP
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+#include "audioio.hpp"
+#include "receiver.hpp"
+#include "ringbuffer.hpp"
+#include "telemetry.hpp"
+
+const int RT_DEFAULT_PRIORITY = 80;          // SCHED_FIFO priority when none is given
+const std::size_t RT_STACK_PREFAULT = 65536; // Worker stack touched before it starts
+const std::size_t RT_EVENT_QUEUE = 4096;     // Events between the worker and the logger (~50 s of frames)
+const int RT_IDLE_US = 2000;                 // Worker sleep between polls of the capture queue
+
+// How the detection worker runs. Whatever cannot be applied (usually for lack of
+// privileges) is reported and skipped; the receiver works the same, only with less
+// protection from the rest of the system.
+struct RealtimeConfig {
+    bool lockMemory; // mlockall the process and stop malloc returning memory to the OS
+    int cpu;         // Pin the worker to this CPU, -1 to leave it to the scheduler
+    int priority;    // SCHED_FIFO priority for the worker, 0 for normal scheduling
+};
+
+// Which settings took effect, and why the others did not
+struct RealtimeStatus {
+    bool memoryLocked;
+    bool pinned;
+    bool fifo;
+    std::string warnings; // One line per setting that was skipped
+};
+
+// What the worker hands the logger: a tone onset, or an analysed frame without a
+// tone (for the quiet / strongest-frequency feedback). Plain data, so it goes
+// through the lock-free queue by memcpy.
+struct RealtimeEvent {
+    char symbol; // '\0' for a frame without a tone
+    bool quiet;
+    std::int64_t energy;
+    std::uint32_t frameSize;
+    std::int32_t row;
+    std::int32_t col;
+    std::uint64_t sampleIndex;
+};
+
+inline ReceiverFrame toReceiverFrame(const RealtimeEvent& event) {
+    ReceiverFrame frame = {event.symbol, event.symbol != '\0', event.quiet, event.energy, event.frameSize,
+                           std::make_pair(static_cast<int>(event.row), static_cast<int>(event.col)), event.sampleIndex};
+    return frame;
+}
+
+// Lock every page the process has and will have, so the worker never waits on a
+// page fault. Needs CAP_IPC_LOCK or a large enough RLIMIT_MEMLOCK.
+inline bool lockProcessMemory(std::string& error) {
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+        error = std::string("mlockall: ") + std::strerror(errno);
+        return false;
+    }
+#ifdef __GLIBC__
+    // Keep freed memory in the (locked) heap instead of trimming or unmapping it
+    mallopt(M_TRIM_THRESHOLD, -1);
+    mallopt(M_MMAP_MAX, 0);
+#endif
+    return true;
+}
+
+inline bool pinThread(std::thread& thread, int cpu, std::string& error) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    int result = pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set);
+    if (result != 0) {
+        error = "CPU affinity: " + std::string(std::strerror(result));
+        return false;
+    }
+    return true;
+#else
+    (void)thread;
+    (void)cpu;
+    error = "CPU affinity: not supported on this platform";
+    return false;
+#endif
+}
+
+inline bool setFifoPriority(std::thread& thread, int priority, std::string& error) {
+    sched_param param;
+    std::memset(&param, 0, sizeof(param));
+    param.sched_priority = priority;
+    int result = pthread_setschedparam(thread.native_handle(), SCHED_FIFO, &param);
+    if (result != 0) {
+        error = "SCHED_FIFO priority " + std::to_string(priority) + ": " + std::strerror(result);
+        return false;
+    }
+    return true;
+}
+
+// DTMFReceiver on a dedicated detection worker that is safe to run next to motion
+// control. Everything it touches is allocated in the constructor (the receiver's
+// buffers, the event queue, the timing histograms); the worker prefaults its stack,
+// then only reads the capture queue, runs the detector and writes fixed-size events
+// into a lock-free queue. Decoding messages and printing happen on whatever thread
+// calls drain() - a plain, non-real-time logger thread.
+class RealtimeReceiver {
+public:
+    RealtimeReceiver(AudioSource& source, int hop, bool sliding, const RealtimeConfig& config)
+        : source(source), receiver(source.sampleRate(), hop, sliding), config(config), events(RT_EVENT_QUEUE),
+          go(false), running(false), dropped(0) {}
+
+    ~RealtimeReceiver() {
+        stop();
+    }
+
+    RealtimeReceiver(const RealtimeReceiver&) = delete;
+    RealtimeReceiver& operator=(const RealtimeReceiver&) = delete;
+
+    // Lock memory, start the worker and apply its affinity and priority before it
+    // processes anything
+    RealtimeStatus start() {
+        RealtimeStatus status = {false, false, false, ""};
+        std::string error;
+        if (config.lockMemory) {
+            status.memoryLocked = lockProcessMemory(error);
+            if (!status.memoryLocked) status.warnings += error + "\n";
+        }
+
+        running.store(true);
+        worker = std::thread(&RealtimeReceiver::run, this);
+        if (config.cpu >= 0) {
+            status.pinned = pinThread(worker, config.cpu, error);
+            if (!status.pinned) status.warnings += error + "\n";
+        }
+        if (config.priority > 0) {
+            status.fifo = setFifoPriority(worker, config.priority, error);
+            if (!status.fifo) status.warnings += error + ", running at normal priority\n";
+        }
+        go.store(true, std::memory_order_release);
+        return status;
+    }
+
+    void stop() {
+        if (!worker.joinable()) return;
+        running.store(false);
+        go.store(true, std::memory_order_release);
+        worker.join();
+    }
+
+    // Logger side: take up to count events
+    std::size_t drain(RealtimeEvent* out, std::size_t count) {
+        return events.read(out, count);
+    }
+
+    // Events lost because the logger fell behind
+    std::uint64_t getDroppedEvents() const {
+        return dropped.load(std::memory_order_relaxed);
+    }
+
+    // Worker timing in nanoseconds: the time each poll that found audio took, and how
+    // late the worker woke from each sleep
+    const TelemetryHistogram& getProcessing() const {
+        return processing;
+    }
+
+    const TelemetryHistogram& getWakeLateness() const {
+        return lateness;
+    }
+
+    std::thread::native_handle_type workerHandle() {
+        return worker.native_handle();
+    }
+
+    // Attach receiver telemetry (also preallocated). Call before start().
+    void setTelemetry(Telemetry* target) {
+        receiver.setTelemetry(target);
+    }
+
+private:
+    // Passes onsets and tone-less frames on to the logger
+    struct Forward {
+        RealtimeReceiver* owner;
+
+        void operator()(const ReceiverFrame& frame) const {
+            if (frame.symbol != '\0' && !frame.onset) return;
+            RealtimeEvent event = {frame.symbol, frame.quiet, frame.energy, static_cast<std::uint32_t>(frame.frameSize),
+                                   frame.strongest.first, frame.strongest.second, frame.sampleIndex};
+            if (owner->events.write(&event, 1) == 0) owner->dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+    };
+
+    // Touch the stack the worker will use so its pages are mapped (and locked) up front
+    __attribute__((noinline)) static void prefaultStack() {
+        unsigned char stack[RT_STACK_PREFAULT];
+        volatile unsigned char* page = stack;
+        for (std::size_t i = 0; i < RT_STACK_PREFAULT; i += 4096) page[i] = 0;
+    }
+
+    void run() {
+        prefaultStack();
+        while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+
+        typedef std::chrono::steady_clock Clock;
+        Forward forward = {this};
+        Clock::time_point wake = Clock::now();
+        while (running.load(std::memory_order_relaxed)) {
+            Clock::time_point begin = Clock::now();
+            lateness.record(std::chrono::duration_cast<std::chrono::nanoseconds>(begin - wake).count());
+            if (receiver.poll(source, forward) > 0) {
+                processing.record(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - begin).count());
+            }
+            wake = Clock::now() + std::chrono::microseconds(RT_IDLE_US);
+            std::this_thread::sleep_until(wake);
+        }
+    }
+
+    AudioSource& source;
+    DTMFReceiver receiver;
+    RealtimeConfig config;
+    SpscRingBuffer<RealtimeEvent> events;
+    TelemetryHistogram processing;
+    TelemetryHistogram lateness;
+    std::atomic<bool> go;
+    std::atomic<bool> running;
+    std::atomic<std::uint64_t> dropped;
+    std::thread worker;
+};
+
+#endif
@@ -0,0 +1,258 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <random>
+#include <algorithm>
+#include <new>
+#include <cmath>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <pthread.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/prctl.h>
+#endif
+#include "synth.hpp"
+#include "protocol.hpp"
+#include "ringbuffer.hpp"
+#include "rtreceiver.hpp"
+
+// Same signal as DTMF2, at DTMF5's capture rate
+const int SAMPLE_RATE = 44100;
+const int AMPLITUDE = 30000;
+const double DURATION = 0.4;   // Tone duration in seconds
+const double GAP = 0.05;       // Silence after each tone in seconds
+const double MESSAGE_GAP = 0.3; // Silence after each message
+const char COMMANDS[] = {'F', 'B', 'L', 'R'};
+const int PERIOD_SAMPLES = 441;             // Capture callback size (10 ms)
+const std::size_t QUEUE_SIZE = 65536;       // Capture queue, as in DTMF5
+const std::size_t LOAD_BUFFER = 32u << 20;  // Per load process: bigger than the caches
+
+// Allocations made by the detection worker once it is running; the real-time path
+// should make none
+std::atomic<bool> watching(false);
+pthread_t watchedThread;
+std::atomic<std::uint64_t> workerAllocations(0);
+
+void* operator new(std::size_t size) {
+    if (watching.load(std::memory_order_acquire) && pthread_equal(pthread_self(), watchedThread)) {
+        workerAllocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    void* p = std::malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+__attribute__((noinline)) void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+__attribute__((noinline)) void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+// Synthetic load, one process per CPU: square roots, a walk over a buffer larger than
+// the caches (evicting the receiver's working set) and heap churn. Separate processes,
+// so the receiver's locked memory and malloc settings do not apply to them.
+void burn(unsigned seed) {
+    std::mt19937 rng(seed);
+    std::vector<double> buffer(LOAD_BUFFER / sizeof(double), 1.0);
+    double sum = 0.0;
+    while (true) {
+        for (int i = 0; i < 100000; ++i) sum += std::sqrt(sum + i);
+        for (std::size_t i = 0; i < buffer.size(); i += 8) buffer[i] += sum;
+        std::vector<char> block(1 + rng() % (1 << 20), 1);
+        sum += block.back();
+    }
+}
+
+std::vector<pid_t> startLoad(unsigned processes) {
+    std::vector<pid_t> children;
+    for (unsigned i = 0; i < processes; ++i) {
+        pid_t pid = fork();
+        if (pid == 0) {
+#ifdef __linux__
+            prctl(PR_SET_PDEATHSIG, SIGKILL);
+#endif
+            burn(i + 1);
+        }
+        if (pid > 0) children.push_back(pid);
+    }
+    return children;
+}
+
+void stopLoad(const std::vector<pid_t>& children) {
+    for (pid_t pid : children) kill(pid, SIGKILL);
+    for (pid_t pid : children) waitpid(pid, nullptr, 0);
+}
+
+// Stands in for the sound card: a producer thread writes the signal into the capture
+// queue one period at a time, at the real capture pace
+class PacedSource : public AudioSource {
+public:
+    PacedSource(const std::vector<std::int16_t>& signal, int sampleRate)
+        : signal(signal), rate(sampleRate), queue(QUEUE_SIZE), overruns(0), done(false) {}
+
+    ~PacedSource() {
+        if (producer.joinable()) producer.join();
+    }
+
+    void start() {
+        producer = std::thread(&PacedSource::play, this);
+    }
+
+    std::size_t read(std::int16_t* samples, std::size_t count) override {
+        return queue.read(samples, count);
+    }
+
+    int sampleRate() const override {
+        return rate;
+    }
+
+    bool finished() const override {
+        return done.load() && queue.size() == 0;
+    }
+
+    std::size_t getOverruns() const {
+        return overruns.load();
+    }
+
+private:
+    void play() {
+        auto period = std::chrono::nanoseconds(1000000000LL * PERIOD_SAMPLES / rate);
+        auto next = std::chrono::steady_clock::now();
+        for (std::size_t position = 0; position < signal.size(); position += PERIOD_SAMPLES) {
+            next += period;
+            std::this_thread::sleep_until(next);
+            std::size_t count = std::min<std::size_t>(PERIOD_SAMPLES, signal.size() - position);
+            overruns += count - queue.write(&signal[position], count);
+        }
+        done.store(true);
+    }
+
+    const std::vector<std::int16_t>& signal;
+    int rate;
+    SpscRingBuffer<std::int16_t> queue;
+    std::atomic<std::size_t> overruns;
+    std::atomic<bool> done;
+    std::thread producer;
+};
+
+// Histogram quantile in microseconds: the upper bound of its bucket, capped at the maximum
+double quantileUs(const TelemetryHistogram& histogram, double q) {
+    return std::min(histogram.quantile(q), histogram.getMax()) / 1000.0;
+}
+
+// One run of the receiver over the whole signal
+void runPhase(const char* name, const std::vector<std::int16_t>& signal, const std::string& sent, bool sliding,
+              const RealtimeConfig& config) {
+    PacedSource source(signal, SAMPLE_RATE);
+    RealtimeReceiver receiver(source, RECEIVER_HOP, sliding, config);
+    CommandDecoder decoder(static_cast<std::uint64_t>(SAMPLE_RATE));
+    std::string received;
+
+    RealtimeStatus status = receiver.start();
+    workerAllocations.store(0);
+    watchedThread = receiver.workerHandle();
+    watching.store(true, std::memory_order_release);
+    source.start();
+
+    // Logger: decode on this thread, never on the worker
+    RealtimeEvent events[64];
+    while (true) {
+        std::size_t count = receiver.drain(events, 64);
+        for (std::size_t i = 0; i < count; ++i) {
+            ReceivedCommand command;
+            if (events[i].symbol != '\0' && decoder.push(events[i].symbol, events[i].sampleIndex, command)) {
+                received += command.command;
+            }
+        }
+        if (count > 0) continue;
+        if (source.finished()) break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10 * RT_IDLE_US / 1000)); // Let the worker go idle
+    receiver.stop();
+    watching.store(false);
+    std::size_t count;
+    while ((count = receiver.drain(events, 64)) > 0) {
+        for (std::size_t i = 0; i < count; ++i) {
+            ReceivedCommand command;
+            if (events[i].symbol != '\0' && decoder.push(events[i].symbol, events[i].sampleIndex, command)) {
+                received += command.command;
+            }
+        }
+    }
+
+    const TelemetryHistogram& lateness = receiver.getWakeLateness();
+    const TelemetryHistogram& processing = receiver.getProcessing();
+    std::cout << name << " (memory " << (status.memoryLocked ? "locked" : "not locked") << ", "
+              << (status.pinned ? "pinned" : "not pinned") << ", " << (status.fifo ? "SCHED_FIFO" : "normal priority")
+              << ")\n";
+    std::cerr << status.warnings;
+    std::cout << "  wake-up lateness: p50 <= " << quantileUs(lateness, 0.5) << " us, p99 <= "
+              << quantileUs(lateness, 0.99) << " us, p99.9 <= " << quantileUs(lateness, 0.999) << " us, max "
+              << lateness.getMax() / 1000.0 << " us over " << lateness.getCount() << " wake-ups\n";
+    std::cout << "  processing per poll: p50 <= " << quantileUs(processing, 0.5) << " us, p99 <= "
+              << quantileUs(processing, 0.99) << " us, max " << processing.getMax() / 1000.0 << " us\n";
+    std::cout << "  " << (received == sent ? "all " : "") << received.size() << "/" << sent.size()
+              << " commands decoded" << (received == sent ? "" : " (MISMATCH)") << ", " << source.getOverruns()
+              << " samples dropped, " << receiver.getDroppedEvents() << " events dropped, "
+              << workerAllocations.load() << " allocations on the worker\n";
+}
+
+// Real-time receiver stress test: DTMF2 messages arrive at the capture pace while
+// every CPU is loaded, and the detection worker's timing is measured twice, as a
+// plain thread and with locked memory, SCHED_FIFO priority and optionally a pinned
+// CPU. Settings the process may not apply are reported and skipped.
+int main(int argc, char* argv[]) {
+    double seconds = 20.0;
+    unsigned load = std::thread::hardware_concurrency();
+    if (load == 0) load = 1;
+    RealtimeConfig realtime = {true, -1, RT_DEFAULT_PRIORITY};
+    bool sliding = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) seconds = std::atof(argv[++i]);
+        else if (std::strcmp(argv[i], "--load") == 0 && i + 1 < argc) load = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--cpu") == 0 && i + 1 < argc) realtime.cpu = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--priority") == 0 && i + 1 < argc) realtime.priority = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--sliding") == 0) sliding = true;
+        else {
+            std::cerr << "Usage: rtstress [--seconds S] [--load PROCESSES] [--cpu N] [--priority P] [--sliding]\n";
+            return -1;
+        }
+    }
+
+    // Messages back to back for the length of each run
+    DTMFSynth synth(SAMPLE_RATE, AMPLITUDE);
+    std::vector<std::int16_t> signal;
+    std::string sent;
+    std::mt19937 rng(1);
+    std::size_t length = static_cast<std::size_t>(seconds * SAMPLE_RATE);
+    while (signal.size() < length) {
+        char command = COMMANDS[rng() % 4];
+        synth.renderSequence(messageSymbols(buildMessage(command)), static_cast<std::size_t>(DURATION * SAMPLE_RATE),
+                             static_cast<std::size_t>(GAP * SAMPLE_RATE), signal);
+        signal.resize(signal.size() + static_cast<std::size_t>(MESSAGE_GAP * SAMPLE_RATE), 0);
+        sent += command;
+    }
+
+    std::cout << sent.size() << " messages, " << static_cast<double>(signal.size()) / SAMPLE_RATE << " s per run, "
+              << load << " load processes\n";
+    std::vector<pid_t> children = startLoad(load);
+
+    // Plain thread first: memory locking cannot be undone for the second run
+    RealtimeConfig plain = {false, -1, 0};
+    runPhase("plain thread", signal, sent, sliding, plain);
+    runPhase("real-time", signal, sent, sliding, realtime);
+
+    stopLoad(children);
+    return 0;
+}
+
+// g++ rtstress.cpp -o rtstress -O2 -std=c++17 -pthread
@@ -0,0 +1,123 @@
+#ifndef SFMLAUDIO_HPP
+#define SFMLAUDIO_HPP
+
+#include <SFML/Audio.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "audioio.hpp"
+#include "ringbuffer.hpp"
+#include "telemetry.hpp"
+
+// Sound card implementations of AudioSource and AudioSink
+
+// Microphone input. The SFML capture thread only copies samples into a lock-free
+// queue; read() drains it from whichever thread does the processing.
+class SfmlSource : public AudioSource {
+public:
+    explicit SfmlSource(int sampleRate, std::size_t queueSize = 65536)
+        : rate(sampleRate), capture(queueSize) {}
+
+    ~SfmlSource() {
+        stop();
+    }
+
+    bool start() {
+        return capture.start(rate);
+    }
+
+    void stop() {
+        capture.stop();
+    }
+
+    std::size_t read(std::int16_t* samples, std::size_t count) override {
+        return capture.queue.read(samples, count);
+    }
+
+    int sampleRate() const override {
+        return rate;
+    }
+
+    // Samples dropped because nobody drained the queue in time
+    std::size_t getOverruns() const {
+        return capture.overruns.load();
+    }
+
+    std::size_t getQueueDepth() const {
+        return capture.queue.size();
+    }
+
+    // Record callback sizes and dropped samples into telemetry. Call before start().
+    void setTelemetry(Telemetry* target) {
+        capture.telemetry = target;
+    }
+
+private:
+    class Capture : public sf::SoundRecorder {
+    public:
+        explicit Capture(std::size_t queueSize) : queue(queueSize), overruns(0), telemetry(nullptr) {}
+
+        ~Capture() {
+            stop();
+        }
+
+        SpscRingBuffer<std::int16_t> queue;
+        std::atomic<std::size_t> overruns;
+        Telemetry* telemetry;
+
+    protected:
+        bool onProcessSamples(const sf::Int16* samples, std::size_t sampleCount) override {
+            std::size_t written = queue.write(samples, sampleCount);
+            if (written < sampleCount) overruns += sampleCount - written;
+            if (telemetry) telemetry->recordCallback(sampleCount, written);
+            return true;
+        }
+    };
+
+    int rate;
+    Capture capture;
+};
+
+// Speaker output. write() plays the samples and returns once they have been heard
+// (or interrupt() stops them), so consecutive writes do not overlap.
+class SfmlSink : public AudioSink {
+public:
+    explicit SfmlSink(int sampleRate) : rate(sampleRate), interrupted(false) {}
+
+    bool write(const std::int16_t* samples, std::size_t count) override {
+        if (interrupted.load()) return true;
+        if (!buffer.loadFromSamples(samples, count, 1, rate)) return false;
+        sound.setBuffer(buffer);
+        sound.play();
+
+        // Wait for the samples to finish playing
+        while (sound.getStatus() == sf::Sound::Playing) {
+            if (interrupted.load()) {
+                sound.stop();
+                break;
+            }
+            sf::sleep(sf::milliseconds(5));
+        }
+        return true;
+    }
+
+    void interrupt() override {
+        interrupted.store(true);
+    }
+
+    void clearInterrupt() override {
+        interrupted.store(false);
+    }
+
+    int sampleRate() const override {
+        return rate;
+    }
+
+private:
+    int rate;
+    sf::SoundBuffer buffer;
+    sf::Sound sound;
+    std::atomic<bool> interrupted;
+};
+
+#endif
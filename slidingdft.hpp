@@ -0,0 +1,144 @@
+#ifndef SLIDINGDFT_HPP
+#define SLIDINGDFT_HPP
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "goertzel.hpp"
+
+// Per-sample DTMF detector.
+// A recursive sliding DFT keeps the 8 tone bins and their second harmonics current
+// over the last windowSize samples, so the decision can be re-run after every sample
+// instead of once per block. A symbol is reported as soon as the same decision has
+// held for minDuration samples.
+//
+// The plain recursion X[n] = x[n] + e^jw X[n-1] - e^jwN x[n-N] is marginally stable:
+// rounding errors never decay. Each bin is damped by r slightly below 1 (and the
+// sample leaving the window by r^N), which bounds the error at a negligible bias.
+class SlidingDFTDetector {
+public:
+    SlidingDFTDetector(int sampleRate, int windowSize, int minDuration,
+                       GoertzelThresholds thresholds = GoertzelThresholds())
+        : windowSize(windowSize), minDuration(minDuration), releaseDuration(windowSize / 2),
+          thresholds(thresholds), twist(makeTwistLimits(thresholds, sampleRate, windowSize)),
+          history(windowSize, 0), cursor(0), energy(0), sampleIndex(0),
+          candidate('\0'), held(0), missed(0), active('\0') {
+        const double damping = 0.99999;
+        double dampingN = std::pow(damping, windowSize);
+        for (int bin = 0; bin < BINS; ++bin) {
+            // Bins 0-7 are the fundamentals (rows, then columns), 8-15 their second harmonics
+            double omega = 2 * 3.14159265358979323846 * (bin < 8 ? 1 : 2) * dtmfToneFrequency(bin % 8) / sampleRate;
+            rotateRe[bin] = damping * std::cos(omega);
+            rotateIm[bin] = damping * std::sin(omega);
+            tailRe[bin] = dampingN * std::cos(omega * windowSize);
+            tailIm[bin] = dampingN * std::sin(omega * windowSize);
+            re[bin] = 0.0;
+            im[bin] = 0.0;
+        }
+    }
+
+    // Feed one sample. Returns the symbol on the sample where it is confirmed, else '\0'.
+    char push(std::int16_t sample) {
+        double x = sample;
+        double oldest = history[cursor];
+        history[cursor] = sample;
+        if (++cursor == windowSize) cursor = 0;
+        energy += static_cast<std::int64_t>(sample) * sample - static_cast<std::int64_t>(oldest * oldest);
+        ++sampleIndex;
+
+        for (int bin = 0; bin < BINS; ++bin) {
+            double r = x + rotateRe[bin] * re[bin] - rotateIm[bin] * im[bin] - tailRe[bin] * oldest;
+            double i = rotateRe[bin] * im[bin] + rotateIm[bin] * re[bin] - tailIm[bin] * oldest;
+            re[bin] = r;
+            im[bin] = i;
+        }
+        return decide();
+    }
+
+    // Symbol currently being held ('\0' between tones)
+    char current() const {
+        return active;
+    }
+
+    // Samples consumed so far
+    std::uint64_t getSampleIndex() const {
+        return sampleIndex;
+    }
+
+    int getWindowSize() const {
+        return windowSize;
+    }
+
+private:
+    static const int BINS = 16;
+
+    char decide() {
+        double power[8];
+        for (int k = 0; k < 8; ++k) power[k] = re[k] * re[k] + im[k] * im[k];
+
+        // Same criteria as the block detectors, on the current window
+        char symbol = '\0';
+        int row, col;
+        if (dtmfCandidate(power, static_cast<double>(energy), windowSize, thresholds, twist, row, col)) {
+            double rowHarmonic = re[8 + row] * re[8 + row] + im[8 + row] * im[8 + row];
+            double colHarmonic = re[12 + col] * re[12 + col] + im[12 + col] * im[12 + col];
+            if (rowHarmonic <= power[row] * thresholds.maxHarmonicRatio &&
+                colHarmonic <= power[4 + col] * thresholds.maxHarmonicRatio) {
+                symbol = DTMF_SYMBOLS[row][col];
+            }
+        }
+
+        if (symbol != '\0' && symbol == candidate) {
+            ++held;
+        } else if (symbol != '\0') {
+            candidate = symbol;
+            held = 1;
+        }
+
+        // Hysteresis: a tone that is on only has to stay the strongest pair and keep
+        // its share of the energy. Twist and dominance are onset checks; an off-frequency
+        // tone that fails them for a while is still the same key, while a real gap
+        // drops the share at once.
+        bool sustained = active != '\0' && energy > 0 && DTMF_SYMBOLS[row][col] == active &&
+                         2.0 * (power[row] + power[4 + col]) >=
+                             thresholds.minToneEnergy * windowSize * static_cast<double>(energy);
+
+        // A tone ends after releaseDuration samples without it, so short dropouts
+        // do not report the same key twice
+        if (symbol == active || sustained) {
+            missed = 0;
+        } else if (active != '\0' && ++missed >= releaseDuration) {
+            active = '\0';
+        }
+        if (symbol == '\0') held = 0;
+
+        // Nothing new starts before that: an off-frequency tone whose decision
+        // flickers to a neighbouring symbol is still one tone
+        if (held >= minDuration && active == '\0') {
+            active = candidate;
+            missed = 0;
+            return active;
+        }
+        return '\0';
+    }
+
+    int windowSize;
+    int minDuration;
+    int releaseDuration;
+    GoertzelThresholds thresholds;
+    TwistLimits twist;
+    std::vector<std::int16_t> history; // Last windowSize samples
+    int cursor;
+    std::int64_t energy;               // Exact sum of squares over the window
+    std::uint64_t sampleIndex;
+    double rotateRe[BINS], rotateIm[BINS];
+    double tailRe[BINS], tailIm[BINS];
+    double re[BINS], im[BINS];
+    char candidate;   // Symbol the current run of decisions agrees on
+    int held;         // Length of that run
+    int missed;       // Samples since the active symbol was last seen
+    char active;      // Last reported symbol, until it is released
+};
+
+#endif
@@ -0,0 +1,209 @@
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <random>
+#include <memory>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include "synth.hpp"
+#include "protocol.hpp"
+#include "audioio.hpp"
+#include "receiver.hpp"
+
+// Same signal as DTMF2
+const int AMPLITUDE = 30000;
+const double DURATION = 0.4;  // Tone duration in seconds
+const double GAP = 0.05;      // Silence after each tone in seconds
+const char COMMANDS[] = {'F', 'B', 'L', 'R'};
+
+// Collects the tones the receiver reports and the commands they decode to,
+// with the sample time the last command was complete at
+struct SymbolLog {
+    std::string symbols;
+    std::string commands;
+    std::uint64_t decodedAt;
+    CommandDecoder decoder;
+    LinkDecoder linkDecoder;
+    bool link;
+
+    SymbolLog(bool link, std::uint64_t maxLinkGap) : decodedAt(0), linkDecoder(maxLinkGap), link(link) {}
+
+    void operator()(const ReceiverFrame& frame) {
+        if (!frame.onset) return;
+        symbols += frame.symbol;
+        if (link) {
+            LinkFrame received;
+            if (linkDecoder.push(frame.symbol, frame.sampleIndex, received)) {
+                commands += received.commands;
+                decodedAt = received.end;
+            }
+        } else {
+            ReceivedCommand command;
+            if (decoder.push(frame.symbol, frame.sampleIndex, command)) {
+                commands += command.command;
+                decodedAt = command.end;
+            }
+        }
+    }
+};
+
+double percentile(std::vector<double> values, double p) {
+    if (values.empty()) return 0.0;
+    std::sort(values.begin(), values.end());
+    return values[static_cast<std::size_t>(p * (values.size() - 1) + 0.5)];
+}
+
+struct SoakConfig {
+    std::uint64_t commands = 10000;
+    int sampleRate = 44100;
+    double noiseRms = 0.0;
+    bool sliding = false;
+    bool link = false;
+    int batch = 1;
+};
+
+// DTMFSynth::renderSequence with both tones of every symbol scale times their
+// nominal frequency, as sent by a transmitter whose clock is off
+void renderShifted(const std::string& symbols, double scale, int sampleRate, std::size_t toneSamples,
+                   std::size_t gapSamples, std::vector<std::int16_t>& out) {
+    for (char symbol : symbols) {
+        int row, col;
+        if (!dtmfPosition(symbol, row, col)) continue;
+        TonePairOscillator tone(DTMF_ROW_FREQS[row] * scale, DTMF_COL_FREQS[col] * scale, AMPLITUDE / 2.0,
+                                AMPLITUDE / 2.0, sampleRate);
+        std::size_t start = out.size();
+        out.resize(start + toneSamples + gapSamples, 0);
+        tone.render(&out[start], toneSamples);
+    }
+}
+
+// One soak run through a fresh receiver, with the transmitted tones offsetPercent
+// off nominal. Prints the summary and returns the number of failed messages or frames.
+std::uint64_t runSoak(const SoakConfig& config, double offsetPercent, WavFileSink* recording) {
+    int sampleRate = config.sampleRate;
+    bool link = config.link;
+
+    // Link frames: short tones, and the pause between frames after the last gap
+    DTMFSynth synth(sampleRate, AMPLITUDE);
+    std::size_t toneSamples = static_cast<std::size_t>(sampleRate * (link ? LINK_TONE_MS / 1000.0 : DURATION));
+    std::size_t gapSamples = static_cast<std::size_t>(sampleRate * (link ? LINK_GAP_MS / 1000.0 : GAP));
+    std::size_t pauseSamples = link ? static_cast<std::size_t>(sampleRate * (LINK_FRAME_GAP_MS - LINK_GAP_MS) / 1000.0) : 0;
+
+    LoopbackAudio channel(sampleRate, config.noiseRms);
+    DTMFReceiver receiver(sampleRate, RECEIVER_HOP, config.sliding);
+    SymbolLog log(link, static_cast<std::uint64_t>(sampleRate) * LINK_MAX_GAP_MS / 1000);
+
+    std::uint64_t commands = config.commands;
+    std::mt19937 rng(1);
+    std::vector<std::int16_t> samples;
+    std::vector<double> latencyMs;
+    std::uint64_t failures = 0, audioSamples = 0, sent = 0, frames = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    while (sent < commands) {
+        // One message, or one link frame of up to batch commands
+        std::string batchCommands;
+        int size = link ? static_cast<int>(std::min<std::uint64_t>(config.batch, commands - sent)) : 1;
+        for (int i = 0; i < size; ++i) batchCommands += COMMANDS[rng() % 4];
+        std::string expected = link ? buildLinkFrame(batchCommands) : messageSymbols(buildMessage(batchCommands[0]));
+
+        samples.clear();
+        if (offsetPercent == 0.0) {
+            synth.renderSequence(expected, toneSamples, gapSamples, samples);
+        } else {
+            renderShifted(expected, 1.0 + offsetPercent / 100.0, sampleRate, toneSamples, gapSamples, samples);
+        }
+        samples.resize(samples.size() + pauseSamples, 0);
+        std::uint64_t frameStart = audioSamples;
+        channel.write(samples.data(), samples.size());
+        if (recording) recording->write(samples.data(), samples.size());
+        audioSamples += samples.size();
+
+        log.symbols.clear();
+        log.commands.clear();
+        receiver.poll(channel, log);
+        if (log.symbols != expected || log.commands != batchCommands) {
+            if (failures < 10) {
+                std::cerr << "Frame " << frames << ": sent " << expected << ", received " << log.symbols
+                          << " (decoded '" << log.commands << "')\n";
+            }
+            ++failures;
+        } else {
+            latencyMs.push_back(1000.0 * (log.decodedAt - frameStart) / sampleRate);
+        }
+        sent += size;
+        ++frames;
+    }
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double audioSeconds = static_cast<double>(audioSamples) / sampleRate;
+    if (offsetPercent != 0.0) std::cout << "Tones " << offsetPercent << " % off nominal: ";
+    std::cout << commands << " commands in " << frames << (link ? " link frames, " : " messages, ") << failures
+              << " failed, " << audioSeconds << " s of audio in " << elapsed << " s (" << audioSeconds / elapsed
+              << "x real time, " << commands / elapsed << " commands/s)\n";
+    std::cout << "Over the air: " << commands / audioSeconds << " commands/s, frame start to decode p50 "
+              << percentile(latencyMs, 0.5) << " ms, p99 " << percentile(latencyMs, 0.99) << " ms\n";
+    return failures;
+}
+
+// Loopback soak test: DTMF2's transmitter feeds DTMF5's receiver through memory,
+// with no audio device and no clock, and every received message is checked.
+// --link sends high-rate link frames instead of "#cmd checksum *" messages.
+// --offset runs the test once per listed frequency error of the transmitter
+// (e.g. -1.5,0,1.5 to cover the +-1.5 % a receiver must accept).
+int main(int argc, char* argv[]) {
+    SoakConfig config;
+    std::vector<double> offsets;
+    bool badOffset = false;
+    const char* wavPath = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--commands") == 0 && i + 1 < argc) config.commands = std::strtoull(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--rate") == 0 && i + 1 < argc) config.sampleRate = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--noise") == 0 && i + 1 < argc) config.noiseRms = std::atof(argv[++i]);
+        else if (std::strcmp(argv[i], "--sliding") == 0) config.sliding = true;
+        else if (std::strcmp(argv[i], "--link") == 0) config.link = true;
+        else if (std::strcmp(argv[i], "--batch") == 0 && i + 1 < argc) config.batch = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--offset") == 0 && i + 1 < argc) {
+            std::stringstream stream(argv[++i]);
+            std::string item;
+            while (std::getline(stream, item, ',')) {
+                double offset = std::atof(item.c_str());
+                if (offset <= -100.0 || offset >= 100.0) badOffset = true;
+                offsets.push_back(offset);
+            }
+        }
+        else if (std::strcmp(argv[i], "--wav") == 0 && i + 1 < argc) wavPath = argv[++i];
+        else {
+            std::cerr << "Usage: soak [--commands N] [--rate HZ] [--noise RMS] [--sliding] [--link [--batch N]]"
+                      << " [--offset PCT[,PCT...]] [--wav FILE]\n";
+            return -1;
+        }
+    }
+    config.sliding = receiverSliding(config.sliding, config.link);
+    if (config.sampleRate < RECEIVER_DETECT_RATE || config.noiseRms < 0.0 || config.batch < 1 ||
+        config.batch > LINK_MAX_BATCH || (config.batch > 1 && !config.link) || badOffset) {
+        std::cerr << "Sample rate must be at least " << RECEIVER_DETECT_RATE << " Hz, noise non-negative, "
+                  << "--batch between 1 and " << LINK_MAX_BATCH << " (link mode only) and offsets within +-100 %\n";
+        return -1;
+    }
+    if (offsets.empty()) offsets.push_back(0.0);
+
+    // Optional copy of everything transmitted
+    std::unique_ptr<WavFileSink> recording;
+    if (wavPath) {
+        recording.reset(new WavFileSink(wavPath, config.sampleRate));
+        if (!recording->isOpen()) {
+            std::cerr << "Cannot write " << wavPath << "\n";
+            return -1;
+        }
+    }
+
+    std::uint64_t failures = 0;
+    for (double offset : offsets) failures += runSoak(config, offset, recording.get());
+    return failures == 0 ? 0 : 1;
+}
+
+// g++ soak.cpp -o soak -O2 -std=c++17
\ No newline at end of file
@@ -0,0 +1,49 @@
+#ifndef STREAMRECORDER_HPP
+#define STREAMRECORDER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include "ringbuffer.hpp"
+#include "sfmlaudio.hpp"
+
+// Streaming replacement for polling sf::SoundBufferRecorder::getBuffer().
+// Captured audio goes into a fixed-size queue instead of an ever-growing buffer;
+// the polling thread drains it as a sliding window of frameSize samples that
+// advances by hop. Memory and per-poll cost stay constant however long it runs.
+class StreamingRecorder {
+public:
+    StreamingRecorder(int sampleRate, std::size_t frameSize, std::size_t hop, std::size_t queueSize = 65536)
+        : source(sampleRate, queueSize), frames(frameSize, hop) {}
+
+    bool start() {
+        return source.start();
+    }
+
+    void stop() {
+        source.stop();
+    }
+
+    // Advance the window; returns true while fresh frames are available
+    bool nextFrame() {
+        return frames.next(source);
+    }
+
+    const std::int16_t* frame() const {
+        return frames.frame();
+    }
+
+    std::size_t frameSize() const {
+        return frames.frameSize();
+    }
+
+    // Samples dropped because nobody drained the queue in time
+    std::size_t getOverruns() const {
+        return source.getOverruns();
+    }
+
+private:
+    SfmlSource source;
+    FrameAssembler<std::int16_t> frames;
+};
+
+#endif
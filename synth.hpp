@@ -0,0 +1,140 @@
+#ifndef SYNTH_HPP
+#define SYNTH_HPP
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "dtmf.hpp"
+
+// Precomputed DTMF tones.
+// Each of the 16 symbols is rendered once into a table that holds a whole number
+// of periods of both of its tones, so the table loops seamlessly and any length of
+// tone is a phase-continuous copy out of it. Playing a key is a table lookup.
+class DTMFSynth {
+public:
+    DTMFSynth(int sampleRate, int amplitude) : sampleRate(sampleRate) {
+        for (int row = 0; row < 4; ++row) {
+            for (int col = 0; col < 4; ++col) {
+                buildLoop(loops[row * 4 + col], DTMF_ROW_FREQS[row], DTMF_COL_FREQS[col], amplitude);
+            }
+        }
+    }
+
+    // Seamless loop for a symbol
+    const std::vector<std::int16_t>& loop(int row, int col) const {
+        return loops[row * 4 + col];
+    }
+
+    // Copy count samples of a symbol starting at phase (a sample index into the loop).
+    // phase is advanced so the next call continues without a discontinuity.
+    void render(int row, int col, std::int16_t* out, std::size_t count, std::size_t& phase) const {
+        const std::vector<std::int16_t>& table = loops[row * 4 + col];
+        phase %= table.size();
+        while (count > 0) {
+            std::size_t chunk = table.size() - phase;
+            if (chunk > count) chunk = count;
+            std::memcpy(out, &table[phase], chunk * sizeof(std::int16_t));
+            out += chunk;
+            count -= chunk;
+            phase = (phase + chunk) % table.size();
+        }
+    }
+
+    // Render a symbol string with exact tone and gap lengths, appending to out.
+    // Returns false (and renders nothing) if a character is not a DTMF symbol.
+    bool renderSequence(const std::string& symbols, std::size_t toneSamples, std::size_t gapSamples,
+                        std::vector<std::int16_t>& out) const {
+        std::size_t start = out.size();
+        out.resize(start + symbols.size() * (toneSamples + gapSamples), 0);
+
+        std::int16_t* cursor = out.data() + start;
+        for (char symbol : symbols) {
+            int row, col;
+            if (!dtmfPosition(symbol, row, col)) {
+                out.resize(start);
+                return false;
+            }
+            std::size_t phase = 0;
+            render(row, col, cursor, toneSamples, phase);
+            cursor += toneSamples + gapSamples; // Gap stays silent
+        }
+        return true;
+    }
+
+    int getSampleRate() const {
+        return sampleRate;
+    }
+
+private:
+    static long gcd(long a, long b) {
+        while (b != 0) {
+            long t = a % b;
+            a = b;
+            b = t;
+        }
+        return a;
+    }
+
+    // Both tones complete an integer number of cycles in sampleRate / gcd(sampleRate, f1, f2) samples
+    void buildLoop(std::vector<std::int16_t>& table, int freq1, int freq2, int amplitude) {
+        std::size_t length = sampleRate / gcd(sampleRate, gcd(freq1, freq2));
+        table.resize(length);
+        for (std::size_t i = 0; i < length; ++i) {
+            double sample = 0.5 * (sin(2 * 3.14159265358979323846 * freq1 * i / sampleRate) +
+                                   sin(2 * 3.14159265358979323846 * freq2 * i / sampleRate));
+            table[i] = static_cast<std::int16_t>(amplitude * sample);
+        }
+    }
+
+    int sampleRate;
+    std::vector<std::int16_t> loops[16];
+};
+
+// Tone pair at arbitrary frequencies and levels, for off-nominal test signals where
+// the looped tables do not apply (frequency offsets, twist). Each tone is a rotating
+// phasor - one complex multiply per sample - renormalised after every call so
+// rounding cannot make the level drift over long tones.
+class TonePairOscillator {
+public:
+    TonePairOscillator(double freq1, double freq2, double amplitude1, double amplitude2, int sampleRate) {
+        setTone(0, freq1, amplitude1, sampleRate);
+        setTone(1, freq2, amplitude2, sampleRate);
+    }
+
+    // Write the next count samples (phase continues from the previous call)
+    void render(std::int16_t* out, std::size_t count) {
+        for (std::size_t i = 0; i < count; ++i) {
+            double sample = amplitude[0] * im[0] + amplitude[1] * im[1];
+            out[i] = static_cast<std::int16_t>(sample < -32768.0 ? -32768.0 : sample > 32767.0 ? 32767.0 : sample);
+            for (int t = 0; t < 2; ++t) {
+                double r = re[t] * stepRe[t] - im[t] * stepIm[t];
+                im[t] = re[t] * stepIm[t] + im[t] * stepRe[t];
+                re[t] = r;
+            }
+        }
+        for (int t = 0; t < 2; ++t) {
+            double norm = 1.0 / std::sqrt(re[t] * re[t] + im[t] * im[t]);
+            re[t] *= norm;
+            im[t] *= norm;
+        }
+    }
+
+private:
+    void setTone(int t, double freq, double level, int sampleRate) {
+        double omega = 2 * 3.14159265358979323846 * freq / sampleRate;
+        stepRe[t] = std::cos(omega);
+        stepIm[t] = std::sin(omega);
+        re[t] = 1.0; // Starts at sin(0), like the tables
+        im[t] = 0.0;
+        amplitude[t] = level;
+    }
+
+    double re[2], im[2];
+    double stepRe[2], stepIm[2];
+    double amplitude[2];
+};
+
+#endif
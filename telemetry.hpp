@@ -0,0 +1,308 @@
+#ifndef TELEMETRY_HPP
+#define TELEMETRY_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "dtmf.hpp"
+#include "goertzel.hpp"
+
+// Receiver telemetry: per-stage timing histograms, capture callback sizes, dropped
+// samples, symbol counts and signal level gauges, dumped as plain "name value" text.
+//
+// Every metric has a single writer thread (the capture callback or the processing
+// thread), so updates are relaxed loads and stores - no locked instructions - and a
+// dump from any thread sees recent, if not perfectly simultaneous, values. When no
+// Telemetry is attached the receiver does not read the clock at all.
+
+enum TelemetryStage {
+    STAGE_DECIMATE,  // Capture rate -> 8 kHz, per chunk
+    STAGE_GATE,      // Frame energy and loudness gate
+    STAGE_TRANSFORM, // Filter bank
+    STAGE_PEAK,      // Strongest row and column
+    STAGE_MATCH,     // Validity, twist and harmonic checks
+    STAGE_SLIDING,   // Sliding mode: whole per-sample detector, per chunk
+    STAGE_COUNT
+};
+
+const char* const TELEMETRY_STAGE_NAMES[STAGE_COUNT] = {"decimate", "gate", "transform", "peak", "match", "sliding"};
+
+// Counter written by one thread
+class TelemetryCounter {
+public:
+    TelemetryCounter() : value(0) {}
+
+    void add(std::uint64_t n) {
+        value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    void set(std::uint64_t n) {
+        value.store(n, std::memory_order_relaxed);
+    }
+
+    std::uint64_t get() const {
+        return value.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<std::uint64_t> value;
+};
+
+// Level written by one thread
+class TelemetryGauge {
+public:
+    TelemetryGauge() : value(0.0) {}
+
+    void set(double v) {
+        value.store(v, std::memory_order_relaxed);
+    }
+
+    double get() const {
+        return value.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<double> value;
+};
+
+// Histogram with power-of-two buckets: bucket b holds values below 2^b (and at least
+// 2^(b-1)), so recording is a bit scan and quantiles are accurate to a factor of two
+class TelemetryHistogram {
+public:
+    static const int BUCKETS = 40;
+
+    void record(std::uint64_t v) {
+        int bucket = v == 0 ? 0 : 64 - __builtin_clzll(v);
+        if (bucket >= BUCKETS) bucket = BUCKETS - 1;
+        buckets[bucket].add(1);
+        count.add(1);
+        sum.add(v);
+        if (v > max.get()) max.set(v);
+    }
+
+    std::uint64_t getCount() const {
+        return count.get();
+    }
+
+    std::uint64_t getMax() const {
+        return max.get();
+    }
+
+    // Upper bound of the bucket holding quantile q
+    std::uint64_t quantile(double q) const {
+        std::uint64_t total = count.get();
+        if (total == 0) return 0;
+        std::uint64_t target = static_cast<std::uint64_t>(std::ceil(q * total)), seen = 0;
+        for (int b = 0; b < BUCKETS; ++b) {
+            seen += buckets[b].get();
+            if (seen >= target && seen > 0) return b == 0 ? 0 : (1ull << b) - 1;
+        }
+        return max.get();
+    }
+
+    // "count=N mean=M p50=A p99=B max=C buckets=<2^b:n,..." (empty buckets left out)
+    std::string format() const {
+        std::ostringstream out;
+        std::uint64_t n = count.get();
+        out << "count=" << n << " mean=" << (n ? sum.get() / n : 0) << " p50=" << quantile(0.5)
+            << " p99=" << quantile(0.99) << " max=" << max.get() << " buckets=";
+        bool first = true;
+        for (int b = 0; b < BUCKETS; ++b) {
+            std::uint64_t c = buckets[b].get();
+            if (c == 0) continue;
+            out << (first ? "" : ",") << "<" << (1ull << b) << ":" << c;
+            first = false;
+        }
+        return out.str();
+    }
+
+private:
+    TelemetryCounter buckets[BUCKETS];
+    TelemetryCounter count;
+    TelemetryCounter sum;
+    TelemetryCounter max;
+};
+
+class Telemetry {
+public:
+    Telemetry() : started(std::chrono::steady_clock::now()) {}
+
+    // Processing thread
+    void recordStage(TelemetryStage stage, std::uint64_t nanoseconds) {
+        stages[stage].record(nanoseconds);
+    }
+
+    // Capture thread: one callback delivered count samples, of which queued made it
+    // into the capture queue
+    void recordCallback(std::size_t count, std::size_t queued) {
+        callbackSizes.record(count);
+        if (queued < count) {
+            droppedSamples.add(count - queued);
+            if (queued > 0) truncatedCallbacks.add(1);
+        }
+    }
+
+    // Processing thread: one analysed frame. Frames without a tone feed the noise floor.
+    void recordFrame(std::int64_t energy, std::size_t frameSize, bool quiet, char symbol, bool onset) {
+        double level = std::sqrt(static_cast<double>(energy) / frameSize);
+        frames.add(1);
+        if (quiet) quietFrames.add(1);
+        rms.set(level);
+        if (symbol == '\0') {
+            double floor = noiseFloor.get();
+            noiseFloor.set(floor == 0.0 ? level : floor + 0.05 * (level - floor));
+        }
+        if (onset) recordOnset(symbol);
+    }
+
+    // Processing thread: a new tone
+    void recordOnset(char symbol) {
+        int row, col;
+        if (dtmfPosition(symbol, row, col)) symbols[row * 4 + col].add(1);
+    }
+
+    std::uint64_t getDroppedSamples() const {
+        return droppedSamples.get();
+    }
+
+    // One "name value" line per metric
+    std::string format() const {
+        std::ostringstream out;
+        out << "uptime_s " << std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count() << "\n";
+        for (int s = 0; s < STAGE_COUNT; ++s) {
+            if (stages[s].getCount() == 0) continue; // Stage not used in this mode
+            out << "stage_ns." << TELEMETRY_STAGE_NAMES[s] << " " << stages[s].format() << "\n";
+        }
+        out << "callback_samples " << callbackSizes.format() << "\n";
+        out << "dropped_samples " << droppedSamples.get() << "\n";
+        out << "truncated_callbacks " << truncatedCallbacks.get() << "\n";
+        out << "frames " << frames.get() << "\n";
+        out << "quiet_frames " << quietFrames.get() << "\n";
+        out << "symbols";
+        for (int row = 0; row < 4; ++row) {
+            for (int col = 0; col < 4; ++col) out << " " << DTMF_SYMBOLS[row][col] << "=" << symbols[row * 4 + col].get();
+        }
+        out << "\n";
+        out << "rms " << rms.get() << "\n";
+        out << "noise_floor_rms " << noiseFloor.get() << "\n";
+        return out.str();
+    }
+
+private:
+    std::chrono::steady_clock::time_point started;
+    TelemetryHistogram stages[STAGE_COUNT];
+    TelemetryHistogram callbackSizes;
+    TelemetryCounter droppedSamples;
+    TelemetryCounter truncatedCallbacks;
+    TelemetryCounter frames;
+    TelemetryCounter quietFrames;
+    TelemetryCounter symbols[16];
+    TelemetryGauge rms;
+    TelemetryGauge noiseFloor;
+};
+
+// Times consecutive stages of the receiver into a Telemetry
+class TelemetryProbe {
+public:
+    explicit TelemetryProbe(Telemetry& telemetry) : telemetry(telemetry), last(std::chrono::steady_clock::now()) {}
+
+    // Restart the clock (the next stage begins now)
+    void start() {
+        last = std::chrono::steady_clock::now();
+    }
+
+    // The given stage ends now
+    void mark(TelemetryStage stage) {
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        telemetry.recordStage(stage, std::chrono::duration_cast<std::chrono::nanoseconds>(now - last).count());
+        last = now;
+    }
+
+    // Hooks inside the frame detectors
+    void mark(DetectStage stage) {
+        mark(static_cast<TelemetryStage>(STAGE_TRANSFORM + stage));
+    }
+
+    void frame(std::int64_t energy, std::size_t frameSize, bool quiet, char symbol, bool onset) {
+        telemetry.recordFrame(energy, frameSize, quiet, symbol, onset);
+    }
+
+    void onset(char symbol) {
+        telemetry.recordOnset(symbol);
+    }
+
+private:
+    Telemetry& telemetry;
+    std::chrono::steady_clock::time_point last;
+};
+
+// Stand-in when telemetry is off; every call compiles away
+struct NullTelemetryProbe {
+    void start() {}
+    void mark(TelemetryStage) {}
+    void mark(DetectStage) {}
+    void frame(std::int64_t, std::size_t, bool, char, bool) {}
+    void onset(char) {}
+};
+
+// Where dumps go: "unix:PATH" sends each dump as one datagram to a local socket
+// (dropped if nobody is listening), anything else is a file that is replaced whole
+// on every dump so readers never see half of one.
+class TelemetryWriter {
+public:
+    explicit TelemetryWriter(const std::string& target) : fd(-1) {
+        if (target.compare(0, 5, "unix:") == 0) {
+            std::string path = target.substr(5);
+            std::memset(&address, 0, sizeof(address));
+            address.sun_family = AF_UNIX;
+            if (path.size() < sizeof(address.sun_path)) {
+                std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+                fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+            }
+        } else {
+            filePath = target;
+        }
+    }
+
+    ~TelemetryWriter() {
+        if (fd >= 0) close(fd);
+    }
+
+    TelemetryWriter(const TelemetryWriter&) = delete;
+    TelemetryWriter& operator=(const TelemetryWriter&) = delete;
+
+    bool isOpen() const {
+        return fd >= 0 || !filePath.empty();
+    }
+
+    bool write(const std::string& text) {
+        if (fd >= 0) {
+            return sendto(fd, text.data(), text.size(), MSG_DONTWAIT, reinterpret_cast<const sockaddr*>(&address),
+                          sizeof(address)) == static_cast<ssize_t>(text.size());
+        }
+        if (filePath.empty()) return false;
+
+        std::string temporary = filePath + ".tmp";
+        std::FILE* file = std::fopen(temporary.c_str(), "w");
+        if (!file) return false;
+        bool ok = std::fwrite(text.data(), 1, text.size(), file) == text.size();
+        ok = std::fclose(file) == 0 && ok;
+        return ok && std::rename(temporary.c_str(), filePath.c_str()) == 0;
+    }
+
+private:
+    int fd;
+    sockaddr_un address;
+    std::string filePath;
+};
+
+#endif
@@ -0,0 +1,139 @@
+#ifndef TRANSMITQUEUE_HPP
+#define TRANSMITQUEUE_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "audioio.hpp"
+
+// Asynchronous transmitter for robot commands. push() returns at once; a dedicated
+// audio thread renders what is pending and plays it on the sink, sleeping on a
+// condition variable while there is nothing to send.
+//
+// What happens to a command pushed while another is on the air:
+//   preempt   the transmission in progress is cut short and anything still pending is
+//             replaced, so the newest command goes out next (latest wins)
+//   otherwise it waits, with up to capacity commands pending; the audio thread takes
+//             up to maxBatch of them at once, so a renderer that can pack several
+//             commands into one transmission (link batch frames) coalesces them
+// A transmission that was cut short is followed by resyncSamples of silence so the
+// receiver sees its last tone end before the next one starts.
+class TransmitQueue {
+public:
+    // Fills samples with the signal for one to maxBatch commands
+    typedef std::function<void(const std::string& commands, std::vector<std::int16_t>& samples)> Renderer;
+
+    TransmitQueue(AudioSink& sink, Renderer render, std::size_t capacity, std::size_t maxBatch, bool preempt,
+                  std::size_t resyncSamples)
+        : sink(sink), render(render), capacity(capacity), maxBatch(maxBatch), preempt(preempt),
+          resyncSamples(resyncSamples), sending(false), cutShort(false), stopping(false), dropped(0), preempted(0) {
+        worker = std::thread(&TransmitQueue::run, this);
+    }
+
+    // Sends whatever is still pending (call cancel() first to drop it)
+    ~TransmitQueue() {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stopping = true;
+        }
+        wake.notify_one();
+        worker.join();
+    }
+
+    TransmitQueue(const TransmitQueue&) = delete;
+    TransmitQueue& operator=(const TransmitQueue&) = delete;
+
+    // Queue a command. False if it was dropped because the queue is full.
+    bool push(char command) {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            if (preempt) {
+                pending.clear();
+                if (sending) {
+                    cutShort = true;
+                    sink.interrupt();
+                    ++preempted;
+                }
+            } else if (pending.size() >= capacity) {
+                ++dropped;
+                return false;
+            }
+            pending += command;
+        }
+        wake.notify_one();
+        return true;
+    }
+
+    // Drop everything pending and stop the transmission in progress
+    void cancel() {
+        std::lock_guard<std::mutex> guard(lock);
+        pending.clear();
+        if (sending) {
+            cutShort = true;
+            sink.interrupt();
+        }
+    }
+
+    std::size_t getDropped() const {
+        std::lock_guard<std::mutex> guard(lock);
+        return dropped;
+    }
+
+    std::size_t getPreempted() const {
+        std::lock_guard<std::mutex> guard(lock);
+        return preempted;
+    }
+
+private:
+    void run() {
+        std::vector<std::int16_t> samples;
+        std::unique_lock<std::mutex> guard(lock);
+        while (true) {
+            wake.wait(guard, [this]() { return !pending.empty() || stopping; });
+            if (pending.empty()) return; // Stopping with nothing left to send
+
+            std::string commands = pending.substr(0, maxBatch);
+            pending.erase(0, commands.size());
+            bool resync = cutShort;
+            cutShort = false;
+            sink.clearInterrupt(); // Only a push from here on may cut this one short
+            sending = true;
+            guard.unlock();
+
+            samples.clear();
+            if (resync) samples.resize(resyncSamples, 0);
+            render(commands, samples);
+            if (!samples.empty() && !sink.write(samples.data(), samples.size())) {
+                std::fprintf(stderr, "Failed to send %s\n", commands.c_str());
+            }
+
+            guard.lock();
+            sending = false;
+        }
+    }
+
+    AudioSink& sink;
+    Renderer render;
+    std::size_t capacity;
+    std::size_t maxBatch;
+    bool preempt;
+    std::size_t resyncSamples;
+
+    mutable std::mutex lock;
+    std::condition_variable wake;
+    std::string pending; // Commands not yet taken by the audio thread
+    bool sending;        // The audio thread is rendering or playing
+    bool cutShort;       // The last transmission was interrupted
+    bool stopping;
+    std::size_t dropped;
+    std::size_t preempted;
+    std::thread worker;
+};
+
+#endif
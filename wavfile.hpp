@@ -0,0 +1,54 @@
+#ifndef WAVFILE_HPP
+#define WAVFILE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Layout of a 16-bit PCM WAV file
+struct WavInfo {
+    int sampleRate;
+    int channels;
+    std::size_t dataOffset; // Byte offset of the first sample
+    std::size_t dataSize;   // Bytes of sample data
+};
+
+inline std::uint32_t readLE32(const unsigned char* p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<std::uint32_t>(p[3]) << 24);
+}
+
+inline std::uint16_t readLE16(const unsigned char* p) {
+    return static_cast<std::uint16_t>(p[0] | (p[1] << 8));
+}
+
+// Walk the RIFF chunks of an in-memory WAV file. Only 16-bit PCM is accepted.
+inline bool parseWavHeader(const unsigned char* data, std::size_t size, WavInfo& info) {
+    if (size < 12 || std::memcmp(data, "RIFF", 4) != 0 || std::memcmp(data + 8, "WAVE", 4) != 0) return false;
+
+    bool haveFormat = false;
+    std::size_t pos = 12;
+    while (pos + 8 <= size) {
+        const unsigned char* chunk = data + pos;
+        std::size_t chunkSize = readLE32(chunk + 4);
+
+        if (std::memcmp(chunk, "fmt ", 4) == 0 && chunkSize >= 16 && pos + 8 + 16 <= size) {
+            std::uint16_t format = readLE16(chunk + 8);
+            std::uint16_t bits = readLE16(chunk + 22);
+            if ((format != 1 && format != 0xFFFE) || bits != 16) return false;
+            info.channels = readLE16(chunk + 10);
+            info.sampleRate = static_cast<int>(readLE32(chunk + 12));
+            haveFormat = true;
+        } else if (std::memcmp(chunk, "data", 4) == 0) {
+            if (!haveFormat || info.channels <= 0 || info.sampleRate <= 0) return false;
+            info.dataOffset = pos + 8;
+            // Streamed files may leave the size unset; clamp to what is there
+            info.dataSize = chunkSize <= size - info.dataOffset ? chunkSize : size - info.dataOffset;
+            return true;
+        }
+
+        pos += 8 + chunkSize + (chunkSize & 1); // Chunks are word aligned
+    }
+    return false;
+}
+
+#endif
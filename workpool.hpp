@@ -0,0 +1,136 @@
+#ifndef WORKPOOL_HPP
+#define WORKPOOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed-size thread pool with one task queue per worker. Tasks submitted from
+// outside the pool are dealt round-robin; a task submitted by a worker goes on that
+// worker's own queue, so a task that reschedules itself stays on a warm cache. A
+// worker whose queue is empty steals from the others before it sleeps.
+//
+// Queues are FIFO at both ends: tasks here are short, and the one that has waited
+// longest has the tightest deadline. Each queue has its own lock, so workers only
+// contend when one steals from another.
+class WorkStealingPool {
+public:
+    typedef std::function<void()> Task;
+
+    explicit WorkStealingPool(unsigned threads) : queues(threads), pending(0), idle(0), nextQueue(0), steals(0), stopping(false) {
+        for (unsigned i = 0; i < threads; ++i) queues[i].reset(new Queue);
+        for (unsigned i = 0; i < threads; ++i) workers.push_back(std::thread(&WorkStealingPool::run, this, i));
+    }
+
+    // Runs every task already submitted, then joins the workers
+    ~WorkStealingPool() {
+        {
+            std::lock_guard<std::mutex> guard(sleepLock);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& worker : workers) worker.join();
+    }
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    void submit(Task task) {
+        std::size_t index = currentWorker(this);
+        if (index >= queues.size()) index = nextQueue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+        {
+            std::lock_guard<std::mutex> guard(queues[index]->lock);
+            queues[index]->tasks.push_back(std::move(task));
+        }
+        pending.fetch_add(1, std::memory_order_seq_cst);
+        if (idle.load(std::memory_order_seq_cst) > 0) {
+            std::lock_guard<std::mutex> guard(sleepLock); // Orders with a worker about to wait
+            wake.notify_one();
+        }
+    }
+
+    unsigned size() const {
+        return static_cast<unsigned>(queues.size());
+    }
+
+    // Tasks run by a worker other than the one they were queued on
+    std::uint64_t getSteals() const {
+        return steals.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct Queue {
+        std::mutex lock;
+        std::deque<Task> tasks;
+    };
+
+    // Index of the calling worker in pool, or SIZE_MAX from any other thread
+    static std::size_t& currentWorker(const WorkStealingPool* pool) {
+        thread_local const WorkStealingPool* owner = nullptr;
+        thread_local std::size_t index = SIZE_MAX;
+        if (owner != pool) {
+            owner = pool;
+            index = SIZE_MAX;
+        }
+        return index;
+    }
+
+    bool popFrom(std::size_t index, Task& task) {
+        Queue& queue = *queues[index];
+        std::lock_guard<std::mutex> guard(queue.lock);
+        if (queue.tasks.empty()) return false;
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+        return true;
+    }
+
+    // Own queue first, then the others starting from the next one along
+    bool take(std::size_t self, Task& task) {
+        if (popFrom(self, task)) return true;
+        for (std::size_t i = 1; i < queues.size(); ++i) {
+            if (popFrom((self + i) % queues.size(), task)) {
+                steals.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void run(std::size_t self) {
+        currentWorker(this) = self;
+        Task task;
+        while (true) {
+            if (take(self, task)) {
+                pending.fetch_sub(1, std::memory_order_seq_cst);
+                task();
+                task = nullptr;
+                continue;
+            }
+
+            std::unique_lock<std::mutex> guard(sleepLock);
+            idle.fetch_add(1, std::memory_order_seq_cst);
+            wake.wait(guard, [this]() { return pending.load(std::memory_order_seq_cst) > 0 || stopping; });
+            idle.fetch_sub(1, std::memory_order_seq_cst);
+            if (stopping && pending.load(std::memory_order_seq_cst) == 0) return;
+        }
+    }
+
+    std::vector<std::unique_ptr<Queue> > queues;
+    std::vector<std::thread> workers;
+    std::atomic<std::size_t> pending; // Tasks queued and not yet taken
+    std::atomic<unsigned> idle;       // Workers asleep or about to be
+    std::atomic<std::size_t> nextQueue;
+    std::atomic<std::uint64_t> steals;
+    std::mutex sleepLock;
+    std::condition_variable wake;
+    bool stopping;
+};
+
+#endif